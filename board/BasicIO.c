@@ -21,11 +21,17 @@
   * v4.2
  *  Created by Todd Morton
  *  Modified to fix bug in BOIGetStrg() so a BS can be the first character pressed.
+ * v4.3
+ *  Neal Crawford, 10/16/2026
+ *  Divisors computed from the core clock and recomputed on clock profile changes
+ *  Added the interrupt driven transmit ring buffer
+ *  Added rates to 1843200, LPUART0 and the throughput self-test
  *******************************************************************************************
 * Project master header file
 ********************************************************************/
 #include "MCUType.h"
 #include "BasicIO.h"
+#include "K22FRDM_ClkCfg.h"
 
 /*******************************************************************************************
 * Private Resources
@@ -33,70 +39,310 @@
 static INT8C bioHtoA(INT8U hnib);   //Convert nibble to ascii
 static INT8U bioIsHex(INT8C c);
 static INT8U bioHtoB(INT8C c);
+static void bioPortInit(void);
+static void bioSetDivisors(void);
+static INT32U bioBaudIn(INT8U profile);
+#if BIO_PORT == BIO_PORT_LPUART0
+static INT32U bioLpuartClk(INT32U pllHz, INT32U* src);
+static INT32U bioLpuartDivisors(INT32U clk, INT32U* osrPtr, INT32U* sbrPtr);
+#else
+static INT32U bioUartDiv32(INT32U clk);
+#endif
+static INT8U bioClkNotify(INT8U phase);
+static INT32U bioBaud;              //Bit rate selected by BIOOpen()
+static INT32U bioActualBaud;        //Bit rate the divisors give
+
+#define BIO_BAUD_TOL_PCT 2U         //Largest bit rate error a clock profile may leave
+
+/* Port registers used by the BIO functions */
+#if BIO_PORT == BIO_PORT_LPUART0
+#define BIO_TDRE()      ((LPUART0->STAT & LPUART_STAT_TDRE_MASK) != 0)
+#define BIO_TC()        ((LPUART0->STAT & LPUART_STAT_TC_MASK) != 0)
+#define BIO_RDRF()      ((LPUART0->STAT & LPUART_STAT_RDRF_MASK) != 0)
+#define BIO_PUT(c)      (LPUART0->DATA = (INT32U)(c))
+#define BIO_GET()       ((INT8C)LPUART0->DATA)
+#define BIO_RX_CLEAR()  (LPUART0->STAT = LPUART0->STAT)    //an overrun stops reception
+#define BIO_TIE_ON()    (LPUART0->CTRL |= LPUART_CTRL_TIE_MASK)
+#define BIO_TIE_OFF()   (LPUART0->CTRL &= ~LPUART_CTRL_TIE_MASK)
+#define BIO_IRQn        LPUART0_IRQn
+#define BIO_IRQHandler  LPUART0_IRQHandler
+#define LPUART_OSR_MIN  4U          //Oversampling ratios, below 8 samples on both edges
+#define LPUART_OSR_MAX  32U
+#define LPUART_SBR_MAX  0x1FFFU
+#else
+#define BIO_TDRE()      ((UART1->S1 & UART_S1_TDRE_MASK) != 0)
+#define BIO_TC()        ((UART1->S1 & UART_S1_TC_MASK) != 0)
+#define BIO_RDRF()      ((UART1->S1 & UART_S1_RDRF_MASK) != 0)
+#define BIO_PUT(c)      (UART1->D = (INT8U)(c))
+#define BIO_GET()       ((INT8C)UART1->D)
+#define BIO_RX_CLEAR()  ((void)0)   //reading S1 then D clears an overrun
+#define BIO_TIE_ON()    (UART1->C2 |= UART_C2_TIE_MASK)
+#define BIO_TIE_OFF()   (UART1->C2 &= (INT8U)~UART_C2_TIE_MASK)
+#define BIO_IRQn        UART1_RX_TX_IRQn
+#define BIO_IRQHandler  UART1_RX_TX_IRQHandler
+#define UART_DIV32_MIN  32U         //SBR 1, the fastest rate is clock / 16
+#endif
+
+#if BIO_TX_BUFFERED_EN
+#define BIO_TX_MASK (BIO_TX_BUF_SIZE - 1U)
+void BIO_IRQHandler(void);
+static INT8U bioTxBuf[BIO_TX_BUF_SIZE];
+static volatile INT16U bioTxHead;   //Written only by BIOWrite()
+static volatile INT16U bioTxTail;   //Written only by the BIO_PORT interrupt
+static BIO_TX_STATS bioTxStats;
+#endif
 /*******************************************************************************************
  * void BIOOpen(INT8U rate) - Initializes UART to operate at a specified rate.
- * MCU: K22, UART1 configured for debugger USB.
+ * MCU: K22, UART1 configured for debugger USB, or LPUART0, see BIO_PORT.
  * Acceptable rates:
  *  BIO_BIT_RATE_9600
  *  BIO_BIT_RATE_19200
  *  BIO_BIT_RATE_38400
  *  BIO_BIT_RATE_57600
  *  BIO_BIT_RATE_115200
+ *  BIO_BIT_RATE_230400
+ *  BIO_BIT_RATE_460800
+ *  BIO_BIT_RATE_921600
+ *  BIO_BIT_RATE_1843200
  ******************************************************************************************/
 void BIOOpen(INT8U rate){
 
-    SIM->SCGC5 |= SIM_SCGC5_PORTE(1); /* Enable clock gate for PORTE */
-    SIM->SCGC4 |= SIM_SCGC4_UART1(1); //enables UART1 clock (120MHz)
-    PORTE->PCR[0]=PORT_PCR_MUX(3);    //ties peripherals to mux address
-    PORTE->PCR[1]=PORT_PCR_MUX(3);
-
     switch(rate){
-    case(BIO_BIT_RATE_9600):
-        UART1->BDH = 0x03U;
-        UART1->BDL = 0x0dU;
-        UART1->C4 = 0x08U;
-        break;
     case(BIO_BIT_RATE_19200):
-        UART1->BDH = 0x01U;
-        UART1->BDL = 0x86U;
-        UART1->C4 = 0x14U;
+        bioBaud = 19200U;
         break;
     case(BIO_BIT_RATE_38400):
-        UART1->BDH = 0x00U;
-        UART1->BDL = 0xc3U;
-        UART1->C4 = 0x0AU;
+        bioBaud = 38400U;
         break;
     case(BIO_BIT_RATE_57600):
-        UART1->BDH = 0x00U;
-        UART1->BDL = 0x82U;
-        UART1->C4 = 0x07U;
+        bioBaud = 57600U;
         break;
     case(BIO_BIT_RATE_115200):
-        UART1->BDH = 0x00U;
-        UART1->BDL = 0x41U;
-        UART1->C4 = 0x03U;
+        bioBaud = 115200U;
+        break;
+    case(BIO_BIT_RATE_230400):
+        bioBaud = 230400U;
+        break;
+    case(BIO_BIT_RATE_460800):
+        bioBaud = 460800U;
+        break;
+    case(BIO_BIT_RATE_921600):
+        bioBaud = 921600U;
+        break;
+    case(BIO_BIT_RATE_1843200):
+        bioBaud = 1843200U;
         break;
     default:    //Default to 9600bps
-        UART1->BDH = 0x03U;
-        UART1->BDL = 0x0dU;
-        UART1->C4 = 0x08U;
+        bioBaud = 9600U;
         break;
     }
+#if BIO_TX_BUFFERED_EN
+    bioTxHead = 0;
+    bioTxTail = 0;
+    bioTxStats.highWater = 0;
+    bioTxStats.dropped = 0;
+    NVIC_ClearPendingIRQ(BIO_IRQn);
+    NVIC_EnableIRQ(BIO_IRQn);
+#endif
+    bioPortInit();
+    (void)ClkAddNotifier(bioClkNotify);
+
+}
+
+/*******************************************************************************************
+* BIOGetBaud() - Returns the bit rate the divisors give
+*******************************************************************************************/
+INT32U BIOGetBaud(void){
+    return bioActualBaud;
+}
+
+/*******************************************************************************************
+* BIOTxDone() - Returns 1 once the last character written has been sent
+*******************************************************************************************/
+INT8U BIOTxDone(void){
+    return BIO_TC() ? 1U : 0U;
+}
+
+/*******************************************************************************************
+* BIOTxIdle() - Returns 1 once nothing is buffered and the last character has been sent
+*******************************************************************************************/
+INT8U BIOTxIdle(void){
+#if BIO_TX_BUFFERED_EN
+    return ((bioTxTail == bioTxHead) && BIO_TC()) ? 1U : 0U;
+#else
+    return BIO_TC() ? 1U : 0U;
+#endif
+}
+
+/*******************************************************************************************
+* bioClkNotify() - Clock profile change. Not ready until the buffer is empty and the last
+*                  character has been sent, then recomputes the divisors for the new clocks.
+*                  Refuses a profile whose clocks can not give bioBaud within
+*                  BIO_BAUD_TOL_PCT, the host would see garbage at the rate it opened.
+*******************************************************************************************/
+static INT8U bioClkNotify(INT8U phase){
+    INT8U ready = 1;
+    INT32U baud;
+    INT32U err;
+    if (phase == CLK_NOTIFY_PRE) {
+        baud = bioBaudIn(ClkGetNextProfile());
+        err = (baud > bioBaud) ? (baud - bioBaud) : (bioBaud - baud);
+        if ((err * 100U) > (bioBaud * BIO_BAUD_TOL_PCT)) {
+            ready = 0;
+        } else {
+            ready = BIOTxIdle();
+        }
+    } else {
+        bioSetDivisors();
+    }
+    return ready;
+}
+
+#if BIO_PORT == BIO_PORT_LPUART0
+/*******************************************************************************************
+* bioPortInit() - Clocks LPUART0, muxes its pins and enables it at bioBaud
+*******************************************************************************************/
+static void bioPortInit(void){
+    SIM->SCGC5 |= SIM_SCGC5_PORTD(1);
+    SIM->SCGC6 |= SIM_SCGC6_LPUART0(1);
+    OSC->CR |= OSC_CR_ERCLKEN_MASK;    //OSCERCLK, the clock source without the PLL
+    BIO_LPUART_PORT->PCR[BIO_LPUART_RX_PIN] = PORT_PCR_MUX(BIO_LPUART_MUX);
+    BIO_LPUART_PORT->PCR[BIO_LPUART_TX_PIN] = PORT_PCR_MUX(BIO_LPUART_MUX);
+    LPUART0->CTRL = 0;
+    bioSetDivisors();                  //enables transmit and receive
+}
+
+/*******************************************************************************************
+* bioSetDivisors() - Selects the LPUART0 clock and the OSR and SBR closest to bioBaud,
+*                    baud = clock / (OSR * SBR). The clock source and divisors can only be
+*                    written while the LPUART is disabled.
+*******************************************************************************************/
+static void bioSetDivisors(void){
+    INT32U src;
+    INT32U osr;
+    INT32U sbr;
+    INT32U clk = bioLpuartClk(ClkGetPllHz(), &src);
+    bioActualBaud = bioLpuartDivisors(clk, &osr, &sbr);
+    LPUART0->CTRL &= ~(LPUART_CTRL_TE_MASK | LPUART_CTRL_RE_MASK);
+    SIM->SOPT2 = (SIM->SOPT2 & ~SIM_SOPT2_LPUARTSRC_MASK) | SIM_SOPT2_LPUARTSRC(src);
+    LPUART0->BAUD = LPUART_BAUD_OSR(osr - 1U) | LPUART_BAUD_SBR(sbr) |
+                    ((osr < 8U) ? LPUART_BAUD_BOTHEDGE_MASK : 0U);
+    LPUART0->CTRL |= LPUART_CTRL_TE_MASK | LPUART_CTRL_RE_MASK;
+}
+
+/*******************************************************************************************
+* bioBaudIn() - The bit rate the divisors for bioBaud would give in a clock profile
+*******************************************************************************************/
+static INT32U bioBaudIn(INT8U profile){
+    INT32U src;
+    INT32U osr;
+    INT32U sbr;
+    return bioLpuartDivisors(bioLpuartClk(ClkGetProfilePllHz(profile), &src), &osr, &sbr);
+}
+
+/*******************************************************************************************
+* bioLpuartClk() - The LPUART0 clock, MCGPLLCLK when it runs and SIM_SOPT2[PLLFLLSEL]
+*                  selects it, OSCERCLK otherwise
+*    src: set to the SIM_SOPT2[LPUARTSRC] value
+*******************************************************************************************/
+static INT32U bioLpuartClk(INT32U pllHz, INT32U* src){
+    INT32U clk = pllHz;
+    *src = 1U;                         //MCGPLLCLK, SIM_SOPT2[PLLFLLSEL] = 1
+    if ((clk == 0) || ((SIM->SOPT2 & SIM_SOPT2_PLLFLLSEL_MASK) != SIM_SOPT2_PLLFLLSEL(1))) {
+        clk = CLK_OSCER_HZ;
+        *src = 2U;                     //OSCERCLK
+    }else{}
+    return clk;
+}
+
+/*******************************************************************************************
+* bioLpuartDivisors() - The OSR and SBR closest to bioBaud from clk
+*    return: the bit rate they give
+*******************************************************************************************/
+static INT32U bioLpuartDivisors(INT32U clk, INT32U* osrPtr, INT32U* sbrPtr){
+    INT32U bestOsr = LPUART_OSR_MAX;
+    INT32U bestSbr = LPUART_SBR_MAX;
+    INT32U bestErr = 0xFFFFFFFFU;
+    INT32U baud;
+    for (INT32U osr = LPUART_OSR_MAX; osr >= LPUART_OSR_MIN; osr--) {
+        INT32U sbr = (clk + ((osr * bioBaud) / 2U)) / (osr * bioBaud);
+        INT32U err;
+        if (sbr == 0) {
+            sbr = 1U;
+        }else if (sbr > LPUART_SBR_MAX) {
+            sbr = LPUART_SBR_MAX;
+        }else{}
+        baud = clk / (osr * sbr);
+        err = (baud > bioBaud) ? (baud - bioBaud) : (bioBaud - baud);
+        if (err < bestErr) {
+            bestErr = err;
+            bestOsr = osr;
+            bestSbr = sbr;
+        }else{}
+    }
+    *osrPtr = bestOsr;
+    *sbrPtr = bestSbr;
+    return clk / (bestOsr * bestSbr);
+}
+#else
+/*******************************************************************************************
+* bioPortInit() - Clocks UART1, muxes PTE0/PTE1 and enables it at bioBaud
+*******************************************************************************************/
+static void bioPortInit(void){
+    SIM->SCGC5 |= SIM_SCGC5_PORTE(1); /* Enable clock gate for PORTE */
+    SIM->SCGC4 |= SIM_SCGC4_UART1(1); //enables UART1 clock (core clock)
+    PORTE->PCR[0]=PORT_PCR_MUX(3);    //ties peripherals to mux address
+    PORTE->PCR[1]=PORT_PCR_MUX(3);
+    bioSetDivisors();
     UART1->C2 |= UART_C2_TE_MASK;    //enables transmission
     UART1->C2 |= UART_C2_RE_MASK;    //enables receive
+}
+
+/*******************************************************************************************
+* bioSetDivisors() - Sets the UART1 SBR and BRFA for bioBaud. UART1 is clocked from the
+*                    core clock, baud = clock / (16 * (SBR + BRFA/32)).
+*******************************************************************************************/
+static void bioSetDivisors(void){
+    INT32U clk = ClkGetCoreHz();
+    INT32U div32 = bioUartDiv32(clk);
+    UART1->BDH = (INT8U)((div32 >> 13) & UART_BDH_SBR_MASK);
+    UART1->BDL = (INT8U)(div32 >> 5);
+    UART1->C4 = (INT8U)((UART1->C4 & (INT8U)~UART_C4_BRFA_MASK) | UART_C4_BRFA(div32 & 0x1FU));
+    bioActualBaud = (INT32U)(((INT64U)clk * 2U) / div32);
+}
+
+/*******************************************************************************************
+* bioBaudIn() - The bit rate the divisors for bioBaud would give in a clock profile
+*******************************************************************************************/
+static INT32U bioBaudIn(INT8U profile){
+    INT32U clk = ClkGetProfileCoreHz(profile);
+    return (INT32U)(((INT64U)clk * 2U) / bioUartDiv32(clk));
+}
 
+/*******************************************************************************************
+* bioUartDiv32() - 32 * (SBR + BRFA/32) closest to bioBaud from clk, limited to the
+*                  fastest rate UART1 can send
+*******************************************************************************************/
+static INT32U bioUartDiv32(INT32U clk){
+    INT32U div32 = ((clk * 2U) + (bioBaud / 2U)) / bioBaud;   //rounded
+    if (div32 < UART_DIV32_MIN) {
+        div32 = UART_DIV32_MIN;
+    }else{}
+    return div32;
 }
+#endif
 
 /*******************************************************************************************
 * BIORead() - Checks for a character received
-*    MCU: K22, UART1
+*    MCU: K22, BIO_PORT
 *    return: ASCII character received or 0 if no character received
 *******************************************************************************************/
 INT8C BIORead(void){
     INT8C c;
-    if ((UART1->S1 & UART_S1_RDRF_MASK) != 0){   //check if char received
-        c = UART1->D;
+    if (BIO_RDRF()){                        //check if char received
+        c = BIO_GET();
     }else{
+        BIO_RX_CLEAR();
         c = '\0';                           //If not return 0
     }
     return (c);
@@ -115,14 +361,111 @@ INT8C BIOGetChar(void){
 
 /*******************************************************************************************
 * BIOWrite() - Sends an ASCII character
-*              Blocks as much as one character time
-*    MCU: K22, UART1
+*              Blocks as much as one character time, or with BIO_TX_BUFFERED_EN
+*              queues it and blocks or drops only while the buffer is full
+*    MCU: K22, BIO_PORT
 *    parameter: c is the ASCII character to be sent
 *******************************************************************************************/
+#if BIO_TX_BUFFERED_EN
 void BIOWrite(INT8C c){
-    while ((UART1->S1 & UART_S1_TDRE_MASK)==0){} //waits until transmission
-    UART1->D = (INT8U)c;                             //is ready
+    INT16U head = bioTxHead;
+    INT16U used = (INT16U)((head - bioTxTail) & BIO_TX_MASK);
+#if BIO_TX_FULL_POLICY == BIO_TX_FULL_BLOCK
+    while (used == BIO_TX_MASK) {                   //waits for the interrupt to make room
+        used = (INT16U)((head - bioTxTail) & BIO_TX_MASK);
+    }
+#endif
+    if (used != BIO_TX_MASK) {
+        bioTxBuf[head] = (INT8U)c;
+        bioTxHead = (INT16U)((head + 1U) & BIO_TX_MASK);
+        used++;
+        if (used > bioTxStats.highWater) {
+            bioTxStats.highWater = used;
+        }else{}
+        BIO_TIE_ON();                               //interrupt sends it
+    }else{
+        bioTxStats.dropped++;
+    }
+}
+
+/*******************************************************************************************
+* BIOTxFlush() - Blocks until every buffered character has been sent
+*******************************************************************************************/
+void BIOTxFlush(void){
+    while (bioTxTail != bioTxHead){}
+    while (!BIO_TC()){}
+}
+
+/*******************************************************************************************
+* BIOTxStats() - Returns the transmit buffer statistics
+*******************************************************************************************/
+void BIOTxStats(BIO_TX_STATS *stats){
+    stats->highWater = bioTxStats.highWater;
+    stats->dropped = bioTxStats.dropped;
+}
+
+/*******************************************************************************************
+* BIO_IRQHandler() - UART1_RX_TX_IRQHandler or LPUART0_IRQHandler. Moves the next
+*    buffered character to the port while TDRE is set and turns the transmit interrupt
+*    off once the buffer is empty. Writing the data register clears TDRE.
+*******************************************************************************************/
+void BIO_IRQHandler(void){
+    INT16U tail = bioTxTail;
+    if (tail != bioTxHead) {
+        if (BIO_TDRE()){
+            BIO_PUT(bioTxBuf[tail]);
+            bioTxTail = (INT16U)((tail + 1U) & BIO_TX_MASK);
+        }else{}
+    }else{
+        BIO_TIE_OFF();
+    }
+}
+#else
+void BIOWrite(INT8C c){
+    while (!BIO_TDRE()){}                           //waits until transmission
+    BIO_PUT(c);                                     //is ready
+}
+#endif
+
+#if BIO_SELF_TEST_EN
+/*******************************************************************************************
+* BIOThroughputTest() - Sends bytes characters of 62 character lines and times them with
+*    the DWT cycle counter, from the first write until the last stop bit has been sent.
+*    return: bytes per second
+*******************************************************************************************/
+INT32U BIOThroughputTest(INT32U bytes){
+    INT32U start;
+    INT32U cycles;
+    INT32U col = 0;
+#if BIO_TX_BUFFERED_EN
+    BIOTxFlush();
+#else
+    while (!BIO_TC()){}
+#endif
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+    start = DWT->CYCCNT;
+    for (INT32U i = 0; i < bytes; i++) {
+        if (col == 60U) {
+            BIOWrite('\r');
+            col++;
+        }else if (col == 61U) {
+            BIOWrite('\n');
+            col = 0;
+        }else{
+            BIOWrite((INT8C)('0' + (col % 10U)));
+            col++;
+        }
+    }
+#if BIO_TX_BUFFERED_EN
+    BIOTxFlush();
+#else
+    while (!BIO_TC()){}
+#endif
+    cycles = DWT->CYCCNT - start;
+    return (cycles == 0) ? 0U : (INT32U)(((INT64U)bytes * ClkGetCoreHz()) / cycles);
 }
+#endif
 
 /*******************************************************************************************
 * BIOPutStrg() - Writes a string to monitor
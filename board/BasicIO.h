@@ -21,6 +21,10 @@
  * v4.2
  *  Created by Todd Morton
  *  Modified to fix bug in BOIGetStrg() so a BS can be the first character pressed.
+ * v4.3
+ *  Neal Crawford, 10/16/2026
+ *  Added the interrupt driven transmit ring buffer
+ *  Added rates to 1843200, LPUART0 and the throughput self-test
 ********************************************************************/
 #ifndef BIO_INCL
 #define BIO_INCL
@@ -33,6 +37,50 @@
 #define BIO_BIT_RATE_38400  2
 #define BIO_BIT_RATE_57600  3
 #define BIO_BIT_RATE_115200 4
+#define BIO_BIT_RATE_230400 5
+#define BIO_BIT_RATE_460800 6
+#define BIO_BIT_RATE_921600 7
+#define BIO_BIT_RATE_1843200 8
+
+/******************************************************************************************
+ * Serial port. BIO_PORT_UART1 is the OpenSDA USB serial port on PTE0/PTE1, clocked from
+ * the core clock. BIO_PORT_LPUART0 is on BIO_LPUART_PORT pins for an external USB serial
+ * adapter, clocked from the PLL, or from the 8MHz OSCERCLK while the PLL is off. The
+ * divisors are computed from the current clocks and recomputed on clock profile changes.
+ * Rates the clock can not reach are clamped to the fastest it can, BIOGetBaud() returns
+ * the rate set. A clock profile change that would leave the rate more than 2% off is
+ * refused, so the port stays at the rate the host opened. In CLK_PROFILE_VLPR both ports
+ * reach 230400 but neither reaches 460800 or above, so at those rates the board stays
+ * in CLK_PROFILE_BOOT.
+ ******************************************************************************************/
+#define BIO_PORT_UART1      0
+#define BIO_PORT_LPUART0    1
+#define BIO_PORT            BIO_PORT_UART1
+
+#define BIO_LPUART_PORT     PORTD   /* PTD2 LPUART0_RX, PTD3 LPUART0_TX */
+#define BIO_LPUART_RX_PIN   2U
+#define BIO_LPUART_TX_PIN   3U
+#define BIO_LPUART_MUX      6U
+
+/******************************************************************************************
+ * Transmit buffering. With BIO_TX_BUFFERED_EN the BIO output functions queue characters
+ * in a ring buffer that the BIO_PORT transmit interrupt empties. When the buffer is full
+ * BIO_TX_FULL_BLOCK waits for room and BIO_TX_FULL_DROP discards the character. The
+ * output functions must not be called with interrupts disabled in BIO_TX_FULL_BLOCK.
+ ******************************************************************************************/
+#define BIO_TX_BUFFERED_EN  1
+#define BIO_TX_BUF_SIZE     512U    /* Must be a power of 2 */
+#define BIO_TX_FULL_BLOCK   0
+#define BIO_TX_FULL_DROP    1
+#define BIO_TX_FULL_POLICY  BIO_TX_FULL_BLOCK
+
+/* Throughput self-test, BIOThroughputTest() */
+#define BIO_SELF_TEST_EN    0
+
+typedef struct {
+    INT16U highWater;   /* Most characters ever waiting in the buffer */
+    INT16U dropped;     /* Characters discarded by BIO_TX_FULL_DROP */
+} BIO_TX_STATS;
 
 /********************************************************************
 * Public Function Prototypes 
@@ -45,9 +93,33 @@
 *  BIO_BIT_RATE_38400
 *  BIO_BIT_RATE_57600
 *  BIO_BIT_RATE_115200
+*  BIO_BIT_RATE_230400
+*  BIO_BIT_RATE_460800
+*  BIO_BIT_RATE_921600
+*  BIO_BIT_RATE_1843200
 ********************************************************************/
 void BIOOpen(INT8U rate);
 
+/********************************************************************
+* BIOGetBaud() - Returns the bit rate the divisors give, which is
+*                off the rate asked for by the divisor rounding
+********************************************************************/
+INT32U BIOGetBaud(void);
+
+/********************************************************************
+* BIOTxDone() - Returns 1 once the last character written has left
+*               the transmit shift register, 0 while sending
+********************************************************************/
+INT8U BIOTxDone(void);
+
+/********************************************************************
+* BIOTxIdle() - Returns 1 once the transmit buffer is empty and the
+*               last character has been sent, 0 while any is left.
+*               Unlike BIOTxDone(), it also sees the characters
+*               still queued with BIO_TX_BUFFERED_EN.
+********************************************************************/
+INT8U BIOTxIdle(void);
+
 /********************************************************************
 * BIORead() - Checks for a character received
 *    return: ASCII character received or 0 if no character received
@@ -79,11 +151,37 @@ INT8U BIOGetStrg(INT8U strglen,INT8C *const strg); /*input a string */
 
 /********************************************************************
 * BIOWrite() - Sends an ASCII character
-*              Blocks as much as one character time
+*              Blocks as much as one character time, or with
+*              BIO_TX_BUFFERED_EN only while the buffer is full
 *    parameter: c is the ASCII character to be sent
 ********************************************************************/
 void BIOWrite(INT8C c);  /* Send an ascii character */
 
+#if BIO_TX_BUFFERED_EN
+/********************************************************************
+* BIOTxFlush() - Blocks until every buffered character has been sent
+********************************************************************/
+void BIOTxFlush(void);
+
+/********************************************************************
+* BIOTxStats() - Returns the transmit buffer statistics
+********************************************************************/
+void BIOTxStats(BIO_TX_STATS *stats);
+#endif
+
+#if BIO_SELF_TEST_EN
+/********************************************************************
+* BIOThroughputTest() - Sends lines of a test pattern as fast as BIO
+*                       allows and times them with the DWT cycle
+*                       counter, from the first write to the last stop
+*                       bit. At most 35 seconds at 120MHz.
+*    parameter: bytes is the number of characters sent
+*    return: the sustained rate in bytes per second, at most
+*            BIOGetBaud() / 10
+********************************************************************/
+INT32U BIOThroughputTest(INT32U bytes);
+#endif
+
 /********************************************************************
 * BIOPutStrg() - Sends a C string
 *    parameter: strg is a pointer to the string
@@ -9,6 +9,7 @@
  * (PLL) that is part of the microcontroller device.
  *
  * 09/13/2018 Todd Morton
+ * 10/16/2026 Neal Crawford, added runtime clock profiles with driver notifiers
  *
  ***************************************************************************************/
 
@@ -16,6 +17,26 @@
 #include <K22FRDM_ClkCfg.h>
 #include "MCUType.h"
 
+#define CLK_PMSTAT_RUN   0x01U
+#define CLK_PMSTAT_VLPR  0x04U
+#define CLK_PMSTAT_HSRUN 0x80U
+
+/* Bus clock of the CLOCK_SETUP clocks, from the MCGOUTCLK dividers */
+#define CLK_BOOT_OUTDIV1 ((SYSTEM_SIM_CLKDIV1_VALUE & SIM_CLKDIV1_OUTDIV1_MASK) >> SIM_CLKDIV1_OUTDIV1_SHIFT)
+#define CLK_BOOT_OUTDIV2 ((SYSTEM_SIM_CLKDIV1_VALUE & SIM_CLKDIV1_OUTDIV2_MASK) >> SIM_CLKDIV1_OUTDIV2_SHIFT)
+#define CLK_BOOT_BUS_HZ  ((SYSTEM_CLOCK / (CLK_BOOT_OUTDIV2 + 1U)) * (CLK_BOOT_OUTDIV1 + 1U))
+
+static INT8U ClkNotify(INT8U phase);
+#if defined(CLOCK_SETUP) && (MCG_MODE == MCG_MODE_PEE)
+static void ClkEnterVlpr(void);
+static void ClkExitVlpr(void);
+#endif
+
+static CLK_NOTIFIER ClkNotifiers[CLK_MAX_NOTIFIERS];
+static INT8U ClkNumNotifiers;
+static INT8U ClkProfile;
+static INT8U ClkNextProfile;        /* The profile being switched to, else ClkProfile */
+
 /****************************************************************************************
  * Configure and start the system clocks based on the settings in K22FRDM_ClkCfg.h
  * Todd Morton, 09/13/2018
@@ -200,4 +221,186 @@ void K22FRDM_BootClock(void){
     NVIC_EnableIRQ(MCG_IRQn);          /* Enable PLL loss of lock interrupt request */
   }
 #endif
+  ClkProfile = CLK_PROFILE_BOOT;
+  ClkNextProfile = CLK_PROFILE_BOOT;
+  ClkNumNotifiers = 0;
+}
+
+/****************************************************************************************
+ * ClkAddNotifier - Registers a notifier, once
+ *   return: 0 if the notifier table is full
+ * Neal Crawford, 10/16/2026
+ * *************************************************************************************/
+INT8U ClkAddNotifier(CLK_NOTIFIER notify){
+    INT8U i;
+    INT8U added = 0;
+    for (i = 0; i < ClkNumNotifiers; i++) {
+        if (ClkNotifiers[i] == notify) {
+            added = 1;
+        } else {}
+    }
+    if ((added == 0) && (ClkNumNotifiers < CLK_MAX_NOTIFIERS)) {
+        ClkNotifiers[ClkNumNotifiers] = notify;
+        ClkNumNotifiers++;
+        added = 1;
+    } else {}
+    return added;
+}
+
+/****************************************************************************************
+ * ClkSetProfile - Switches between the CLOCK_SETUP clocks and VLPR. The MCG and the run
+ *                 mode are changed with interrupts disabled, if every notifier is ready.
+ *                 Tries once, a busy driver is not waited for. Non-PEE clock setups stay
+ *                 in CLK_PROFILE_BOOT.
+ *   return: 1 if in profile on return
+ * Neal Crawford, 10/16/2026
+ * *************************************************************************************/
+INT8U ClkSetProfile(INT8U profile){
+    INT8U done = 1;
+#if defined(CLOCK_SETUP) && (MCG_MODE == MCG_MODE_PEE)
+    if (profile != ClkProfile) {
+        __disable_irq();
+        ClkNextProfile = profile;
+        done = ClkNotify(CLK_NOTIFY_PRE);
+        if (done != 0) {
+            if (profile == CLK_PROFILE_VLPR) {
+                ClkEnterVlpr();
+            } else {
+                ClkExitVlpr();
+            }
+            ClkProfile = profile;
+            (void)ClkNotify(CLK_NOTIFY_POST);
+        } else {
+            ClkNextProfile = ClkProfile;
+        }
+        __enable_irq();
+    } else {}
+#else
+    done = (profile == ClkProfile) ? 1U : 0U;
+#endif
+    return done;
+}
+
+/****************************************************************************************
+ * ClkGetProfile, ClkGetCoreHz, ClkGetBusHz - The current profile and its clocks
+ * *************************************************************************************/
+INT8U ClkGetProfile(void){
+    return ClkProfile;
+}
+
+INT32U ClkGetCoreHz(void){
+    return ClkGetProfileCoreHz(ClkProfile);
+}
+
+INT32U ClkGetBusHz(void){
+    INT32U hz;
+#ifdef CLOCK_SETUP
+    if (ClkProfile == CLK_PROFILE_VLPR) {
+        hz = CLK_VLPR_BUS_HZ;
+    } else {
+        hz = CLK_BOOT_BUS_HZ;
+    }
+#else
+    hz = DEFAULT_SYSTEM_CLOCK;
+#endif
+    return hz;
+}
+
+/****************************************************************************************
+ * ClkGetNextProfile - The profile being switched to while the CLK_NOTIFY_PRE notifiers
+ *                     run, ClkGetProfile() otherwise
+ * *************************************************************************************/
+INT8U ClkGetNextProfile(void){
+    return ClkNextProfile;
+}
+
+/****************************************************************************************
+ * ClkGetProfileCoreHz, ClkGetProfilePllHz - The core clock and MCGPLLCLK in profile
+ * *************************************************************************************/
+INT32U ClkGetProfileCoreHz(INT8U profile){
+    INT32U hz;
+#ifdef CLOCK_SETUP
+    if (profile == CLK_PROFILE_VLPR) {
+        hz = CLK_VLPR_CORE_HZ;
+    } else {
+        hz = SYSTEM_CLOCK;
+    }
+#else
+    (void)profile;
+    hz = DEFAULT_SYSTEM_CLOCK;
+#endif
+    return hz;
+}
+
+/****************************************************************************************
+ * ClkGetPllHz - MCGPLLCLK, the peripheral clock SIM_SOPT2[PLLFLLSEL] = 1 selects.
+ *               The PLL only runs in PEE setups and is off in CLK_PROFILE_VLPR.
+ * *************************************************************************************/
+INT32U ClkGetPllHz(void){
+    return ClkGetProfilePllHz(ClkProfile);
+}
+
+INT32U ClkGetProfilePllHz(INT8U profile){
+    INT32U hz = 0;
+#if defined(CLOCK_SETUP) && (MCG_MODE == MCG_MODE_PEE)
+    if (profile != CLK_PROFILE_VLPR) {
+        hz = SYSTEM_CLOCK * (CLK_BOOT_OUTDIV1 + 1U);
+    } else {}
+#else
+    (void)profile;
+#endif
+    return hz;
+}
+
+/****************************************************************************************
+ * ClkNotify - Calls every notifier with phase
+ *   return: 0 if a CLK_NOTIFY_PRE notifier is not ready
+ * *************************************************************************************/
+static INT8U ClkNotify(INT8U phase){
+    INT8U i;
+    INT8U ready = 1;
+    for (i = 0; i < ClkNumNotifiers; i++) {
+        if (ClkNotifiers[i](phase) == 0) {
+            ready = 0;
+        } else {}
+    }
+    return ready;
+}
+
+#if defined(CLOCK_SETUP) && (MCG_MODE == MCG_MODE_PEE)
+/****************************************************************************************
+ * ClkEnterVlpr - PEE to PBE, HSRUN to RUN, PBE to BLPE, RUN to VLPR. The clocks must be
+ *                within the RUN limits before leaving HSRUN and the VLPR limits before
+ *                entering VLPR.
+ * *************************************************************************************/
+static void ClkEnterVlpr(void){
+    MCG->C1 = (INT8U)((MCG->C1 & (INT8U)~MCG_C1_CLKS_MASK) | MCG_C1_CLKS(2));   /* PBE, MCGOUTCLK is the crystal */
+    while ((MCG->S & MCG_S_CLKST_MASK) != MCG_S_CLKST(2)) {}
+    if (SMC->PMSTAT == CLK_PMSTAT_HSRUN) {
+        SMC->PMCTRL = (INT8U)(SMC->PMCTRL & (INT8U)~SMC_PMCTRL_RUNM_MASK);
+        while (SMC->PMSTAT != CLK_PMSTAT_RUN) {}
+    } else {}
+    SIM->CLKDIV1 = CLK_VLPR_SIM_CLKDIV1_VALUE;
+    MCG->C2 |= MCG_C2_LP_MASK;                                                   /* BLPE, PLL off */
+    SMC->PMCTRL = (INT8U)((SMC->PMCTRL & (INT8U)~SMC_PMCTRL_RUNM_MASK) | SMC_PMCTRL_RUNM(2));
+    while (SMC->PMSTAT != CLK_PMSTAT_VLPR) {}
+}
+
+/****************************************************************************************
+ * ClkExitVlpr - VLPR to RUN, BLPE to PBE, RUN to HSRUN if CLOCK_SETUP uses it, PBE to PEE
+ * *************************************************************************************/
+static void ClkExitVlpr(void){
+    SMC->PMCTRL = (INT8U)(SMC->PMCTRL & (INT8U)~SMC_PMCTRL_RUNM_MASK);
+    while (SMC->PMSTAT != CLK_PMSTAT_RUN) {}
+    while ((PMC->REGSC & PMC_REGSC_REGONS_MASK) == 0) {}    /* Regulator in run regulation */
+    MCG->C2 &= (INT8U)~MCG_C2_LP_MASK;                         /* PBE, PLL on */
+    while ((MCG->S & MCG_S_LOCK0_MASK) == 0) {}
+#if (((SYSTEM_SMC_PMCTRL_VALUE) & SMC_PMCTRL_RUNM_MASK) == (0x03U << SMC_PMCTRL_RUNM_SHIFT))
+    SMC->PMCTRL = (INT8U)((SMC->PMCTRL & (INT8U)~SMC_PMCTRL_RUNM_MASK) | SMC_PMCTRL_RUNM(3));
+    while (SMC->PMSTAT != CLK_PMSTAT_HSRUN) {}
+#endif
+    SIM->CLKDIV1 = SYSTEM_SIM_CLKDIV1_VALUE;
+    MCG->C1 &= (INT8U)~MCG_C1_CLKS_MASK;                       /* PEE */
+    while ((MCG->S & MCG_S_CLKST_MASK) != MCG_S_CLKST(3)) {}
 }
+#endif
@@ -238,4 +238,72 @@
  ***************************************************************************************/
 void K22FRDM_BootClock(void);
 
+/****************************************************************************************
+ * Runtime clock profiles, Neal Crawford 10/16/2026
+ * Only PEE clock setups can change profile.
+ *   CLK_PROFILE_BOOT ... the CLOCK_SETUP clocks, in HSRUN or RUN as it selects
+ *   CLK_PROFILE_VLPR ... BLPE from the 8MHz crystal, in VLPR mode
+ *                        Core clock = 4MHz, Bus clock = 4MHz, Flash clock = 1MHz
+ ***************************************************************************************/
+#define CLK_PROFILE_BOOT  0U
+#define CLK_PROFILE_VLPR  1U
+
+#define CLK_OSCER_HZ      8000000u      /* OSCERCLK, the FRDM-K22F crystal, in every profile */
+#define CLK_VLPR_CORE_HZ  4000000u
+#define CLK_VLPR_BUS_HZ   4000000u
+/* SIM_CLKDIV1: OUTDIV1=1,OUTDIV2=1,OUTDIV3=1,OUTDIV4=7 */
+#define CLK_VLPR_SIM_CLKDIV1_VALUE 0x11170000U
+
+/* Drivers whose divisors depend on the core or bus clock register a notifier. It is
+ * called twice for every profile change, with interrupts disabled:
+ *   CLK_NOTIFY_PRE  ... old clocks. Returns 0 if the driver is busy or can not run at
+ *                       the clocks of ClkGetNextProfile(), ClkSetProfile() then
+ *                       returns 0 without changing. Must not block.
+ *   CLK_NOTIFY_POST ... new clocks, the driver reprograms its divisors.  */
+#define CLK_NOTIFY_PRE    0U
+#define CLK_NOTIFY_POST   1U
+#define CLK_MAX_NOTIFIERS 4U
+
+typedef INT8U (*CLK_NOTIFIER)(INT8U phase);
+
+/****************************************************************************************
+ * ClkAddNotifier - Registers a notifier, once
+ *   return: 0 if the notifier table is full
+ ***************************************************************************************/
+INT8U ClkAddNotifier(CLK_NOTIFIER notify);
+
+/****************************************************************************************
+ * ClkSetProfile - Switches to CLK_PROFILE_x. Returns at once if already in it or if a
+ *                 notifier is busy, otherwise switches, waiting for the PLL to lock when
+ *                 leaving VLPR. Call it again later to retry.
+ *   return: 1 if in profile on return, 0 if not switched this time
+ ***************************************************************************************/
+INT8U ClkSetProfile(INT8U profile);
+
+/****************************************************************************************
+ * ClkGetProfile, ClkGetCoreHz, ClkGetBusHz - The current profile and its clocks
+ ***************************************************************************************/
+INT8U ClkGetProfile(void);
+INT32U ClkGetCoreHz(void);
+INT32U ClkGetBusHz(void);
+
+/****************************************************************************************
+ * ClkGetNextProfile - The profile being switched to, for a CLK_NOTIFY_PRE notifier that
+ *                     must check the new clocks. ClkGetProfile() outside a change.
+ ***************************************************************************************/
+INT8U ClkGetNextProfile(void);
+
+/****************************************************************************************
+ * ClkGetPllHz - The PLL output in the current profile
+ *   return: 0 if the PLL is not running
+ ***************************************************************************************/
+INT32U ClkGetPllHz(void);
+
+/****************************************************************************************
+ * ClkGetProfileCoreHz, ClkGetProfilePllHz - The core clock and the PLL output a profile
+ *                                          runs at, the PLL 0 if it is off
+ ***************************************************************************************/
+INT32U ClkGetProfileCoreHz(INT8U profile);
+INT32U ClkGetProfilePllHz(INT8U profile);
+
 #endif  /* #if !defined(K22FRDM_CLKCFG_H_) */
@@ -0,0 +1,174 @@
+/****************************************************************************************
+* K22FRDM_Power.c - K22 low power mode support package
+* Neal Crawford, 10/16/2026
+*
+* LPTMR0 counts the slow IRC, resetting every POWER_TICK_MS. Each compare interrupt adds
+* a period to TickBase, so the time base does not wrap between state changes however
+* long the CPU stays in one state.
+****************************************************************************************/
+#include "MCUType.h"
+#include "K22FRDM_Power.h"
+#include "BasicIO.h"
+
+#define POWER_TICK_PERIOD ((POWER_TICK_HZ * POWER_TICK_MS) / 1000U)    // In slow IRC ticks
+#define PMSTAT_HSRUN      0x80U
+
+#if (POWER_TICK_PERIOD == 0) || (POWER_TICK_PERIOD > 0x10000U)
+#error "POWER_TICK_MS must fit the 16 bit LPTMR0 compare"
+#endif
+
+/* SMC_PMPROT is write once and K22FRDM_BootClock() writes SYSTEM_SMC_PMPROT_VALUE */
+#if POWER_STOP_MODE == POWER_STOP_LLS
+#define POWER_PMPROT_MASK SMC_PMPROT_ALLS_MASK
+#else
+#define POWER_PMPROT_MASK SMC_PMPROT_AVLP_MASK
+#endif
+#if (SYSTEM_SMC_PMPROT_VALUE & POWER_PMPROT_MASK) == 0
+#error "SYSTEM_SMC_PMPROT_VALUE does not allow POWER_STOP_MODE"
+#endif
+
+/****************************************************************************************
+* Function prototypes
+****************************************************************************************/
+static INT32U PowerNow(void);
+static void PowerMark(INT8U state);
+static void PowerClockRestore(INT8U mcgC1);
+void LPTMR0_IRQHandler(void);
+void LLWU_IRQHandler(void);
+
+/****************************************************************************************
+* Static file variables
+****************************************************************************************/
+static volatile INT32U TickBase;            // Slow IRC ticks at the last LPTMR0 compare
+static INT32U StateTicks[POWER_NUM_STATES];
+static INT32U LastMark;                     // PowerNow() at the last state change
+
+/****************************************************************************************
+* PowerInit - Starts LPTMR0 and the LLS wake-up sources
+****************************************************************************************/
+void PowerInit(void) {
+    INT8U i;
+
+    /* Slow IRC as MCGIRCLK, kept on in stop modes */
+    MCG->C2 &= (INT8U)~MCG_C2_IRCS_MASK;
+    MCG->C1 |= MCG_C1_IRCLKEN_MASK | MCG_C1_IREFSTEN_MASK;
+
+    SIM->SCGC5 |= SIM_SCGC5_LPTMR_MASK;
+    LPTMR0->CSR = 0;                        // Disabled to write PSR and CMR
+    LPTMR0->PSR = LPTMR_PSR_PCS(0) | LPTMR_PSR_PBYP_MASK;  // MCGIRCLK, no prescaler
+    LPTMR0->CMR = LPTMR_CMR_COMPARE(POWER_TICK_PERIOD - 1U);
+    LPTMR0->CSR = LPTMR_CSR_TCF_MASK | LPTMR_CSR_TIE_MASK | LPTMR_CSR_TEN_MASK;
+    NVIC_ClearPendingIRQ(LPTMR0_IRQn);
+    NVIC_EnableIRQ(LPTMR0_IRQn);
+
+    /* LLS wake-up sources, LPTMR0 is LLWU module 0 */
+    LLWU->ME = LLWU_ME_WUME0_MASK;
+    LLWU->PE4 = LLWU_PE4_WUPE12(2);         // PTD0, FXOS INT1, falling edge
+    LLWU->F2 = LLWU_F2_WUF12_MASK;
+    NVIC_ClearPendingIRQ(LLWU_IRQn);
+    NVIC_EnableIRQ(LLWU_IRQn);
+
+    TickBase = 0;
+    LastMark = 0;
+    for (i = 0; i < POWER_NUM_STATES; i++) {
+        StateTicks[i] = 0;
+    }
+}
+
+/****************************************************************************************
+* PowerWait - Sleeps in wait mode until the next interrupt
+****************************************************************************************/
+void PowerWait(void) {
+    PowerMark(POWER_STATE_RUN);
+    __WFI();
+    PowerMark(POWER_STATE_WAIT);
+}
+
+/****************************************************************************************
+* PowerStop - Stops in POWER_STOP_MODE until the next wake-up interrupt. The BasicIO port
+*             clock stops too, the buffered characters are let finish first.
+****************************************************************************************/
+void PowerStop(void) {
+    if (SMC->PMSTAT == PMSTAT_HSRUN) {
+        PowerWait();
+    } else {
+        INT8U mcgC1 = MCG->C1;
+        while (BIOTxIdle() == 0) {}
+        PowerMark(POWER_STATE_RUN);
+        SMC->PMCTRL = (INT8U)((SMC->PMCTRL & (INT8U)~SMC_PMCTRL_STOPM_MASK) | SMC_PMCTRL_STOPM(POWER_STOP_MODE));
+        (void)SMC->PMCTRL;                  // Write must complete before WFI
+        SCB->SCR |= SCB_SCR_SLEEPDEEP_Msk;
+        __WFI();
+        SCB->SCR &= ~SCB_SCR_SLEEPDEEP_Msk;
+        PowerClockRestore(mcgC1);
+        PowerMark(POWER_STATE_STOP);
+    }
+}
+
+/****************************************************************************************
+* PowerStats - Time spent in each state since PowerInit()
+****************************************************************************************/
+void PowerStats(INT32U* msInState) {
+    INT8U i;
+    PowerMark(POWER_STATE_RUN);
+    for (i = 0; i < POWER_NUM_STATES; i++) {
+        msInState[i] = (INT32U)(((INT64U)StateTicks[i] * 1000U) / POWER_TICK_HZ);
+    }
+}
+
+/****************************************************************************************
+* PowerNow - Slow IRC ticks since PowerInit(). Writing CNR latches the count for reading.
+*            A compare whose interrupt is still pending is counted here, the counter has
+*            already restarted from 0 unless it is still at the compare value.
+****************************************************************************************/
+static INT32U PowerNow(void) {
+    INT32U count;
+    INT32U base;
+    __disable_irq();
+    LPTMR0->CNR = 0;
+    count = LPTMR0->CNR;
+    base = TickBase;
+    if (((LPTMR0->CSR & LPTMR_CSR_TCF_MASK) != 0) && (count < (POWER_TICK_PERIOD / 2U))) {
+        base += POWER_TICK_PERIOD;
+    } else {}
+    __enable_irq();
+    return base + count;
+}
+
+/****************************************************************************************
+* PowerMark - Charges the time since the last mark to state
+****************************************************************************************/
+static void PowerMark(INT8U state) {
+    INT32U now = PowerNow();
+    StateTicks[state] += now - LastMark;
+    LastMark = now;
+}
+
+/****************************************************************************************
+* PowerClockRestore - Stop modes disable the PLL and wake up from PEE in PBE. Waits for
+*                     the PLL to lock and switches back to PEE. Nothing to do otherwise.
+*   mcgC1: MCG_C1 before the stop
+****************************************************************************************/
+static void PowerClockRestore(INT8U mcgC1) {
+    if (((MCG->C6 & MCG_C6_PLLS_MASK) != 0) && ((mcgC1 & MCG_C1_CLKS_MASK) == MCG_C1_CLKS(0))) {
+        while ((MCG->S & MCG_S_LOCK0_MASK) == 0) {}
+        MCG->C1 &= (INT8U)~MCG_C1_CLKS_MASK;
+        while ((MCG->S & MCG_S_CLKST_MASK) != MCG_S_CLKST(3)) {}
+    } else {}
+}
+
+/****************************************************************************************
+* LPTMR0_IRQHandler - Counter period end, also the timed wake-up from stop
+****************************************************************************************/
+void LPTMR0_IRQHandler(void) {
+    LPTMR0->CSR |= LPTMR_CSR_TCF_MASK;
+    TickBase += POWER_TICK_PERIOD;
+}
+
+/****************************************************************************************
+* LLWU_IRQHandler - LLS wake-up. Module flags are cleared by the module's own handler,
+*                   the PTD0 pin flag is cleared here and PORTD_IRQHandler still runs.
+****************************************************************************************/
+void LLWU_IRQHandler(void) {
+    LLWU->F2 = LLWU_F2_WUF12_MASK;
+}
@@ -0,0 +1,52 @@
+/****************************************************************************************
+* K22FRDM_Power.h - K22 low power mode support package
+* Neal Crawford, 10/16/2026
+*
+* Wait (WFI) while peripherals keep running and VLPS or LLS while nothing but a wake-up
+* source needs a clock. LPTMR0 runs from the 32kHz slow IRC in all of these modes. It
+* wakes the CPU every POWER_TICK_MS and times the counters returned by PowerStats().
+****************************************************************************************/
+#ifndef K22FRDM_POWER_H_
+#define K22FRDM_POWER_H_
+
+/* Stop mode entered by PowerStop(), SMC_PMCTRL[STOPM] values. LLS only wakes on LLWU
+ * sources, LPTMR0 and the FXOS INT1 pin (PTD0, LLWU_P12) are enabled. */
+#define POWER_STOP_VLPS 2U
+#define POWER_STOP_LLS  3U
+#define POWER_STOP_MODE POWER_STOP_VLPS
+
+#define POWER_TICK_HZ 32768U       // Slow IRC
+#define POWER_TICK_MS 100U         // Longest stop, switches are polled at this rate
+
+/* States counted by PowerStats() */
+#define POWER_STATE_RUN  0U
+#define POWER_STATE_WAIT 1U
+#define POWER_STATE_STOP 2U
+#define POWER_NUM_STATES 3U
+
+/****************************************************************************************
+* PowerInit - Starts LPTMR0 and the LLS wake-up sources. The stop modes are allowed by
+*             SYSTEM_SMC_PMPROT_VALUE, written by K22FRDM_BootClock().
+****************************************************************************************/
+void PowerInit(void);
+
+/****************************************************************************************
+* PowerWait - Sleeps in wait mode until the next interrupt
+****************************************************************************************/
+void PowerWait(void);
+
+/****************************************************************************************
+* PowerStop - Stops until the next wake-up interrupt, or at most POWER_TICK_MS. Stop modes
+*             can not be entered from HSRUN, PowerWait() is used instead while in HSRUN.
+*             Use CLK_PROFILE_VLPR or a RUN clock setup to stop.
+*             The PLL is relocked and selected again on wake-up.
+****************************************************************************************/
+void PowerStop(void);
+
+/****************************************************************************************
+* PowerStats - Time spent in each state since PowerInit()
+*   msInState: POWER_NUM_STATES counters in mS, indexed by POWER_STATE_x
+****************************************************************************************/
+void PowerStats(INT32U* msInState);
+
+#endif
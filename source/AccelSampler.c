@@ -0,0 +1,375 @@
+/****************************************************************************************
+ * DESCRIPTION: Interrupt driven accelerometer sampling engine. The FXOS data-ready
+ *              interrupt or PIT0 starts sample reads and each sample is handed to the
+ *              event loop through a single-producer/single-consumer queue, so the
+ *              event loop is free to process or sleep between samples. With
+ *              SAMPLER_HW_TRIGGER_EN no reads run between captures, the FXOS transient
+ *              interrupt restarts sampling. Arming first reads TRANSIENT_SRC in place of
+ *              a sample, so the event the capture itself latched does not retrigger.
+ * AUTHOR: Neal Crawford
+ * HISTORY: Started 10/16/2026
+*****************************************************************************************
+* Master header file
+****************************************************************************************/
+#include "MCUType.h"
+#include "FXOS8700CQ.h"
+#include "AccelSampler.h"
+
+#include "K22FRDM_ClkCfg.h"
+
+#define SAMPLE_HZ 800U
+#if SAMPLER_MODE == SAMPLER_MODE_FIFO
+#define PIT_PERIOD_SAMPLES SAMPLER_FIFO_WATERMARK
+#elif SAMPLER_MODE == SAMPLER_MODE_DRDY
+#define PIT_PERIOD_SAMPLES SAMPLER_STUCK_PERIODS     // Stuck read watch only
+#else
+#define PIT_PERIOD_SAMPLES 1U
+#endif
+
+#if (SAMPLER_MODE != SAMPLER_MODE_SINGLE) && !SAMPLER_ASYNC_I2C_EN
+#error "FIFO and DRDY modes require SAMPLER_ASYNC_I2C_EN"
+#endif
+#if SAMPLER_HW_TRIGGER_EN && (SAMPLER_MODE == SAMPLER_MODE_DRDY)
+#error "SAMPLER_HW_TRIGGER_EN needs a PIT driven mode"
+#endif
+#define QUEUE_MASK (SAMPLE_QUEUE_SIZE - 1U)
+
+#if SAMPLER_MODE == SAMPLER_MODE_FIFO
+#define SAMPLER_READ_START(cb) AccelFifoDrainStart(cb)
+#else
+#define SAMPLER_READ_START(cb) AccelSampleStart(cb)
+#endif
+
+/* SamplerArmed states, SAMPLER_HW_TRIGGER_EN */
+#define SAMPLER_RUN     0U      // Sampling
+#define SAMPLER_ARMING  1U      // The next PIT0 tick reads TRANSIENT_SRC instead of a sample
+#define SAMPLER_ARMED   2U      // Waiting for INT1, PIT0 stopped
+
+/****************************************************************************************
+* Function prototypes
+****************************************************************************************/
+static void PITInit(void);
+static INT32U PITLoadValue(void);
+static INT8U SamplerClkNotify(INT8U phase);
+void PORTD_IRQHandler(void);
+static void SampleQueuePut(ACCEL_DATA_3D* accelData);
+#if SAMPLER_ASYNC_I2C_EN
+static void SamplerStartRead(void);
+#endif
+void PIT0_IRQHandler(void);
+#if SAMPLER_HW_TRIGGER_EN
+static void ArmDone(void);
+static void TransientDone(void);
+#endif
+
+/****************************************************************************************
+* Static file variables
+****************************************************************************************/
+static ACCEL_DATA_3D SampleQueue[SAMPLE_QUEUE_SIZE];
+static volatile INT16U QueueHead;      // Written only by the ISR
+static volatile INT16U QueueTail;      // Written only by the event loop
+static volatile ACCEL_SAMPLER_STATS SamplerStats;
+static INT32U SamplerClkCval;          // PIT0 count left and bus clock when the clock
+static INT32U SamplerClkHz;            // profile change started
+#if SAMPLER_ASYNC_I2C_EN
+static INT8U MissRun;                  // Periods missed in a row, interrupt context only
+static INT16U ReadsStarted;
+#endif
+#if SAMPLER_MODE == SAMPLER_MODE_DRDY
+static INT16U WatchReads;              // ReadsStarted at the last PIT0 watch tick
+#endif
+#if SAMPLER_HW_TRIGGER_EN
+static volatile INT8U SamplerArmed;     // SAMPLER_RUN, SAMPLER_ARMING or SAMPLER_ARMED
+static volatile INT8U HwTriggered;      // Set by the transient interrupt, taken by the event loop
+#endif
+
+/****************************************************************************************
+* AccelSamplerInit - Start sampling at 800 Hz. AccelInit() must be called first.
+****************************************************************************************/
+void AccelSamplerInit(void) {
+    QueueHead = 0;
+    QueueTail = 0;
+    SamplerStats.queueOverruns = 0;
+    SamplerStats.deadlineMisses = 0;
+    SamplerStats.fifoOverflows = 0;
+    SamplerStats.readAborts = 0;
+#if SAMPLER_MODE == SAMPLER_MODE_DRDY
+    AccelDrdyInit();
+    PITInit();
+#else
+#if SAMPLER_MODE == SAMPLER_MODE_FIFO
+    AccelFifoInit(SAMPLER_FIFO_WATERMARK);
+#endif
+    PITInit();
+#if SAMPLER_HW_TRIGGER_EN
+    SamplerArmed = SAMPLER_RUN;
+    HwTriggered = 0;
+    AccelTransientInit(SAMPLER_TRANSIENT_THS, SAMPLER_TRANSIENT_COUNT);
+    (void)AccelSamplerArm();
+#endif
+#endif
+}
+
+#if SAMPLER_HW_TRIGGER_EN
+/****************************************************************************************
+* AccelSamplerArm - Asks PIT0 to arm the sampler. Its next tick reads TRANSIENT_SRC in
+*                   place of a sample, which clears the event the capture latched, then
+*                   PIT0 stops and the INT1 interrupt is enabled. A read in flight or
+*                   stuck is handled as for a sample. INT1 is level sensitive, so motion
+*                   after TRANSIENT_SRC was read still fires as soon as it is enabled.
+*   return: 1 if the sampler is armed and the event loop may sleep
+****************************************************************************************/
+INT8U AccelSamplerArm(void) {
+    INT8U armed = SamplerArmed;
+    if ((armed == SAMPLER_RUN) && (HwTriggered == 0)) {
+        SamplerArmed = SAMPLER_ARMING;
+    } else if (armed == SAMPLER_ARMED) {
+        QueueTail = QueueHead;      // Samples left over from the last capture
+    } else {}
+    return (armed == SAMPLER_ARMED) ? 1U : 0U;
+}
+
+/****************************************************************************************
+* ArmDone - TRANSIENT_SRC read, INT1 released. Stops PIT0 and enables the INT1 pin
+*           interrupt. Interrupt context.
+****************************************************************************************/
+static void ArmDone(void) {
+    PIT->CHANNEL[0].TCTRL = 0;
+    PIT->CHANNEL[0].TFLG = PIT_TFLG_TIF(1);
+    NVIC_ClearPendingIRQ(PIT0_IRQn);
+    SamplerArmed = SAMPLER_ARMED;
+    ACCEL_INT1_PORT->PCR[ACCEL_INT1_PIN] = PORT_PCR_MUX(1) | PORT_PCR_IRQC(0x8) | PORT_PCR_ISF_MASK; // GPIO, logic 0
+}
+
+/****************************************************************************************
+* AccelSamplerTriggered - Takes the hardware trigger
+*   return: 1 once after each transient interrupt, 0 otherwise
+****************************************************************************************/
+INT8U AccelSamplerTriggered(void) {
+    INT8U triggered = HwTriggered;
+    HwTriggered = 0;
+    return triggered;
+}
+
+/****************************************************************************************
+* PORTD_IRQHandler - FXOS INT1 transient event. The pin interrupt is turned off and
+*                    TRANSIENT_SRC is read to release INT1, no other read can be in flight
+*                    while armed.
+****************************************************************************************/
+void PORTD_IRQHandler(void) {
+    ACCEL_INT1_PORT->PCR[ACCEL_INT1_PIN] = PORT_PCR_MUX(1) | PORT_PCR_ISF_MASK;  // Interrupt off
+    (void)AccelTransientAck(TransientDone);
+}
+
+/****************************************************************************************
+* TransientDone - TRANSIENT_SRC read, restart sampling at 800 Hz. Interrupt context.
+****************************************************************************************/
+static void TransientDone(void) {
+    SamplerArmed = SAMPLER_RUN;
+    HwTriggered = 1;
+    PIT->CHANNEL[0].TFLG = PIT_TFLG_TIF(1);
+    PIT->CHANNEL[0].TCTRL = PIT_TCTRL_TIE(1) | PIT_TCTRL_TEN(1);
+}
+#endif
+
+/****************************************************************************************
+* AccelSamplerGet - Removes the oldest queued sample.
+*   return: 1 if a sample was copied into accelData, 0 if the queue is empty
+****************************************************************************************/
+INT8U AccelSamplerGet(ACCEL_DATA_3D* accelData) {
+    INT8U sampleReady = 0;
+    INT16U tail = QueueTail;
+    if (tail != QueueHead) {
+        *accelData = SampleQueue[tail];
+        QueueTail = (INT16U)((tail + 1U) & QUEUE_MASK);
+        sampleReady = 1;
+    } else {}
+    return sampleReady;
+}
+
+/****************************************************************************************
+* AccelSamplerStats - Returns the overrun counters of the sampling engine
+****************************************************************************************/
+void AccelSamplerStats(ACCEL_SAMPLER_STATS* stats) {
+    stats->queueOverruns = SamplerStats.queueOverruns;
+    stats->deadlineMisses = SamplerStats.deadlineMisses;
+#if SAMPLER_MODE == SAMPLER_MODE_FIFO
+    stats->fifoOverflows = AccelFifoOverflows();
+#else
+    stats->fifoOverflows = 0;
+#endif
+    stats->sampleOverwrites = AccelOverwrites();
+    stats->readAborts = SamplerStats.readAborts;
+}
+
+/****************************************************************************************
+* SampleQueuePut - Called from interrupt context only. Drops the sample if the event
+*                  loop has fallen a full queue behind.
+****************************************************************************************/
+static void SampleQueuePut(ACCEL_DATA_3D* accelData) {
+    INT16U head = QueueHead;
+    INT16U next = (INT16U)((head + 1U) & QUEUE_MASK);
+    if (next != QueueTail) {
+        SampleQueue[head] = *accelData;
+        QueueHead = next;
+    } else {
+        SamplerStats.queueOverruns++;
+    }
+}
+
+#if SAMPLER_MODE == SAMPLER_MODE_DRDY
+/****************************************************************************************
+* PORTD_IRQHandler - FXOS INT1 data-ready. Starts one non-blocking read per new sample,
+*                    so the read rate follows the sensor's own 800 Hz clock. A read
+*                    still in flight when the next sample is ready is a missed period.
+****************************************************************************************/
+void PORTD_IRQHandler(void) {
+    ACCEL_INT1_PORT->ISFR = PORT_ISFR_ISF(1U << ACCEL_INT1_PIN);
+    SamplerStartRead();
+}
+
+/****************************************************************************************
+* PIT0_IRQHandler - Every SAMPLER_STUCK_PERIODS sample periods. INT1 stays low until the
+*                   sample is read, so no data-ready edge comes after one was missed:
+*                   - A read busy since before the last tick is stuck. It is dropped and
+*                     a new one started.
+*                   - With no read in flight and INT1 low, the edge came while the last
+*                     read was running. The read it asked for is started.
+****************************************************************************************/
+void PIT0_IRQHandler(void) {
+    PIT->CHANNEL[0].TFLG = PIT_TFLG_TIF(1);
+    if (AccelReadBusy() != 0) {
+        if (ReadsStarted == WatchReads) {
+            AccelReadAbort();
+            SamplerStats.readAborts++;
+            SamplerStartRead();
+        } else {}
+    } else if ((ACCEL_INT1_GPIO->PDIR & (1U << ACCEL_INT1_PIN)) == 0) {
+        ACCEL_INT1_PORT->ISFR = PORT_ISFR_ISF(1U << ACCEL_INT1_PIN);   // This read answers
+        NVIC_ClearPendingIRQ(ACCEL_INT1_IRQ);                          // an edge pending now
+        SamplerStartRead();
+    } else {}
+    WatchReads = ReadsStarted;
+}
+#elif SAMPLER_MODE == SAMPLER_MODE_FIFO
+/****************************************************************************************
+* PIT0_IRQHandler - Starts a FIFO drain every SAMPLER_FIFO_WATERMARK sample periods, the
+*                   I2C0 interrupt queues every drained sample. A drain still in flight
+*                   at the next tick is a missed period.
+****************************************************************************************/
+void PIT0_IRQHandler(void) {
+    PIT->CHANNEL[0].TFLG = PIT_TFLG_TIF(1);
+    SamplerStartRead();
+}
+#elif SAMPLER_ASYNC_I2C_EN
+/****************************************************************************************
+* PIT0_IRQHandler - Starts one non-blocking read every 1.25mS, the I2C0 interrupt queues
+*                   the sample. A read still in flight at the next tick is a missed period.
+****************************************************************************************/
+void PIT0_IRQHandler(void) {
+    PIT->CHANNEL[0].TFLG = PIT_TFLG_TIF(1);
+    SamplerStartRead();
+}
+#else
+/****************************************************************************************
+* PIT0_IRQHandler - Reads one sample every 1.25mS. If the PIT has already expired again
+*                   by the time the sample is queued, a sample period was missed. While
+*                   arming, starts the TRANSIENT_SRC read instead.
+****************************************************************************************/
+void PIT0_IRQHandler(void) {
+    ACCEL_DATA_3D currAccelSample;
+
+    PIT->CHANNEL[0].TFLG = PIT_TFLG_TIF(1);
+#if SAMPLER_HW_TRIGGER_EN
+    if (SamplerArmed == SAMPLER_ARMING) {
+        (void)AccelTransientAck(ArmDone);   // Retried on the next tick if refused
+    } else {
+        AccelSampleTask(&currAccelSample);
+        SampleQueuePut(&currAccelSample);
+    }
+#else
+    AccelSampleTask(&currAccelSample);
+    SampleQueuePut(&currAccelSample);
+#endif
+
+    if ((PIT->CHANNEL[0].TFLG & PIT_TFLG_TIF_MASK) != 0) {
+        SamplerStats.deadlineMisses++;
+    } else {}
+}
+#endif
+
+#if SAMPLER_ASYNC_I2C_EN
+/****************************************************************************************
+* SamplerStartRead - Starts the next non-blocking read, or the TRANSIENT_SRC read while
+*                    arming. A read still in flight is a missed period, after
+*                    SAMPLER_STUCK_PERIODS in a row it is dropped and the next period
+*                    starts a new one. Interrupt context.
+****************************************************************************************/
+static void SamplerStartRead(void) {
+    INT8U started;
+#if SAMPLER_HW_TRIGGER_EN
+    if (SamplerArmed == SAMPLER_ARMING) {
+        started = AccelTransientAck(ArmDone);
+    } else {
+        started = SAMPLER_READ_START(SampleQueuePut);
+    }
+#else
+    started = SAMPLER_READ_START(SampleQueuePut);
+#endif
+    if (started != 0) {
+        ReadsStarted++;
+        MissRun = 0;
+    } else {
+        SamplerStats.deadlineMisses++;
+        MissRun++;
+        if (MissRun >= SAMPLER_STUCK_PERIODS) {
+            AccelReadAbort();
+            SamplerStats.readAborts++;
+            MissRun = 0;
+        } else {}
+    }
+}
+#endif
+
+/****************************************************************************************
+* PITInit - Configure PIT to interrupt every 1.25mS, the sample period of the accelerometer,
+*           or every SAMPLER_FIFO_WATERMARK sample periods in FIFO mode and every
+*           SAMPLER_STUCK_PERIODS in DRDY mode
+****************************************************************************************/
+static void PITInit(void) {
+    SIM->SCGC6 |= SIM_SCGC6_PIT(1);  // Enable PIT module
+    PIT->MCR = PIT_MCR_MDIS(0);     // Enable clock for standard PIT timers
+    PIT->CHANNEL[0].LDVAL = PITLoadValue();
+    (void)ClkAddNotifier(SamplerClkNotify);
+    PIT->CHANNEL[0].TFLG = PIT_TFLG_TIF(1);
+    NVIC_ClearPendingIRQ(PIT0_IRQn);
+    NVIC_EnableIRQ(PIT0_IRQn);
+    PIT->CHANNEL[0].TCTRL = PIT_TCTRL_TIE(1) | PIT_TCTRL_TEN(1); // Enable PIT Timer and interrupt
+}
+
+/****************************************************************************************
+* PITLoadValue - PIT0 LDVAL for PIT_PERIOD_SAMPLES sample periods at the current bus clock
+****************************************************************************************/
+static INT32U PITLoadValue(void) {
+    return ((ClkGetBusHz() / SAMPLE_HZ) * PIT_PERIOD_SAMPLES) - 1U;
+}
+
+/****************************************************************************************
+* SamplerClkNotify - Clock profile change. A running PIT0 finishes the period in progress
+*                    at the new bus clock, scaled from the count left, then reloads a full
+*                    period. Restarting the period instead could overflow the FXOS FIFO.
+****************************************************************************************/
+static INT8U SamplerClkNotify(INT8U phase) {
+    if (phase == CLK_NOTIFY_PRE) {
+        SamplerClkCval = PIT->CHANNEL[0].CVAL;
+        SamplerClkHz = ClkGetBusHz();
+    } else if ((PIT->CHANNEL[0].TCTRL & PIT_TCTRL_TEN_MASK) != 0) {
+        PIT->CHANNEL[0].TCTRL = 0;
+        PIT->CHANNEL[0].LDVAL = (INT32U)(((INT64U)SamplerClkCval * ClkGetBusHz()) / SamplerClkHz);
+        PIT->CHANNEL[0].TCTRL = PIT_TCTRL_TIE(1) | PIT_TCTRL_TEN(1);
+        PIT->CHANNEL[0].LDVAL = PITLoadValue();     // Loaded at the end of this period
+    } else {
+        PIT->CHANNEL[0].LDVAL = PITLoadValue();
+    }
+    return 1;
+}
@@ -0,0 +1,85 @@
+/****************************************************************************************
+ * DESCRIPTION: Header for the interrupt driven accelerometer sampling engine.
+ *              The FXOS8700CQ is read on its data-ready interrupt, every 1.25mS PIT0
+ *              tick, or by draining its FIFO, and each sample is queued for the
+ *              event loop.
+ * AUTHOR: Neal Crawford
+ * HISTORY: Started 10/16/2026
+ ***************************************************************************************/
+#ifndef ACCEL_SAMPLER_DEF
+#define ACCEL_SAMPLER_DEF
+
+#define SAMPLE_QUEUE_SIZE 256U     // Must be a power of 2, 320mS of samples at 800 Hz
+
+/* 1: PIT0 starts a non-blocking I2C0/eDMA read, 0: PIT0 blocks in AccelSampleTask() */
+#define SAMPLER_ASYNC_I2C_EN 1
+
+/* Acquisition modes */
+#define SAMPLER_MODE_SINGLE 0U  // One status+XYZ read every 1.25mS PIT tick
+#define SAMPLER_MODE_FIFO   1U  // FXOS FIFO drained every SAMPLER_FIFO_WATERMARK samples
+#define SAMPLER_MODE_DRDY   2U  // One status+XYZ read per FXOS data-ready interrupt on INT1
+#define SAMPLER_MODE SAMPLER_MODE_FIFO
+
+/* Samples per FIFO drain, 30mS at 800 Hz. Leaves room in the 32-sample FIFO for the
+ * samples that arrive while the ~3.5mS burst read is running. */
+#define SAMPLER_FIFO_WATERMARK 24U
+
+/* A non-blocking read still in flight for this many periods in a row will not finish, it
+ * is dropped with AccelReadAbort() so sampling can go on. In DRDY mode PIT0 runs at this
+ * many sample periods only to watch for it and for a data-ready edge missed while a read
+ * was running, no new edge comes while INT1 is held low. */
+#define SAMPLER_STUCK_PERIODS 4U
+
+/* 1: between captures the sampler is armed, with no reads and no I2C traffic, until the
+ * FXOS transient detector pulls INT1. Sampling then restarts and AccelSamplerTriggered()
+ * replaces the software trigger. The threshold is in 63mg steps, 31 is about the 2 g
+ * of the software trigger, on high-pass filtered data. */
+#define SAMPLER_HW_TRIGGER_EN    0
+#define SAMPLER_TRANSIENT_THS    31U
+#define SAMPLER_TRANSIENT_COUNT  2U    // Debounce, 2.5mS at 800 Hz
+
+typedef struct {
+    INT16U queueOverruns;   // Samples dropped because the queue was full
+    INT16U deadlineMisses;  // Sample periods missed because the previous read had not finished
+    INT16U fifoOverflows;   // FIFO drains that found samples overwritten (FIFO mode only)
+    INT16U sampleOverwrites;// Reads that found STATUS[ZYXOW] set, a sample was skipped
+    INT16U readAborts;      // Reads dropped after SAMPLER_STUCK_PERIODS missed periods
+} ACCEL_SAMPLER_STATS;
+
+/****************************************************************************************
+* Public Functions
+*****************************************************************************************
+* AccelSamplerInit - Start sampling at 800 Hz. AccelInit() must be called first.
+****************************************************************************************/
+void AccelSamplerInit(void);
+
+/****************************************************************************************
+* AccelSamplerGet - Removes the oldest queued sample.
+*   return: 1 if a sample was copied into accelData, 0 if the queue is empty
+****************************************************************************************/
+INT8U AccelSamplerGet(ACCEL_DATA_3D* accelData);
+
+/****************************************************************************************
+* AccelSamplerStats - Returns the overrun counters of the sampling engine
+****************************************************************************************/
+void AccelSamplerStats(ACCEL_SAMPLER_STATS* stats);
+
+#if SAMPLER_HW_TRIGGER_EN
+/****************************************************************************************
+* AccelSamplerArm - Stops sampling, empties the queue and waits for the FXOS transient
+*                   interrupt. The transient event latched during the capture is
+*                   cleared first, on the next sample period, so call it on each pass
+*                   until it returns 1. Does nothing while a trigger is still to be
+*                   taken by AccelSamplerTriggered().
+*   return: 1 if the sampler is armed and the event loop may sleep
+****************************************************************************************/
+INT8U AccelSamplerArm(void);
+
+/****************************************************************************************
+* AccelSamplerTriggered - Takes the hardware trigger
+*   return: 1 once after each transient interrupt, 0 otherwise
+****************************************************************************************/
+INT8U AccelSamplerTriggered(void);
+#endif
+
+#endif
@@ -0,0 +1,273 @@
+/****************************************************************************************
+ * DESCRIPTION: CRC-16/CCITT-FALSE on the K22 CRC module with an eDMA feed, and the
+ *              software CRC it is checked against. See Crc.h.
+ * AUTHOR: Neal Crawford
+ * HISTORY: Started 10/16/2026
+*****************************************************************************************
+* Master header file
+****************************************************************************************/
+#include "MCUType.h"
+#include "Crc.h"
+#if CRC_HW_EN && CRC_DMA_EN
+#include "FXOS8700CQ.h"
+#endif
+
+#define CRC_POLY          0x1021U
+#define CRC_TEST_BYTES    131U      // Odd, so every alignment leaves a ragged end
+#define CRC_TEST_SPLIT    37U       // Where the continued CRC restarts
+
+/* 16 bit CRC, no final XOR, result not transposed. Written words are byte transposed
+ * so the first byte in memory goes in first, most significant bit first. */
+#define CRC_CTRL_DATA     CRC_CTRL_TOT(3)
+#define CRC_DMA_MAX_WORDS 0x7FFFU   // 15 bit major loop count
+
+#if CRC_HW_EN && CRC_DMA_EN && ((CRC_DMA_CH != 1U) || (ACCEL_DMA_CH != 0U))
+#error "CrcInit() swaps the priorities of eDMA channels 0 and 1"
+#endif
+
+/****************************************************************************************
+* Function prototypes
+****************************************************************************************/
+static INT16U CrcSwByte(INT16U crc, INT8U byte);
+#if CRC_HW_EN
+static void CrcDmaWait(void);
+#endif
+
+/****************************************************************************************
+* Static file variables
+****************************************************************************************/
+/* CRC-16/CCITT-FALSE (poly 0x1021) by nibble, 32 bytes of table */
+static const INT16U CrcTable[16] = {
+    0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+    0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF
+};
+static const INT8U CrcCheckData[9] = {'1', '2', '3', '4', '5', '6', '7', '8', '9'};
+
+#if CRC_HW_EN
+static const INT8U* CrcTail;        // Bytes after the eDMA transfer, fed when it ends
+static INT32U CrcTailBytes;
+static INT8U CrcDmaBusy;
+#else
+static INT16U CrcSwState;
+#endif
+
+/****************************************************************************************
+* CrcInit - Clocks the CRC module and the eDMA channel
+****************************************************************************************/
+void CrcInit(void) {
+#if CRC_HW_EN
+    SIM->SCGC6 |= SIM_SCGC6_CRC_MASK;
+    CRC0->CTRL = CRC_CTRL_DATA;
+    CRC0->GPOLY = CRC_POLY;
+#if CRC_DMA_EN
+    SIM->SCGC6 |= SIM_SCGC6_DMAMUX_MASK;
+    SIM->SCGC7 |= SIM_SCGC7_DMA_MASK;
+    DMA0->DCHPRI1 = DMA_DCHPRI1_CHPRI(0);  // Below ACCEL_DMA_CH, priorities must be unique
+    DMA0->DCHPRI0 = DMA_DCHPRI0_CHPRI(1);
+    DMAMUX->CHCFG[CRC_DMA_CH] = 0;
+#endif
+    CrcDmaBusy = 0;
+#endif
+    CrcStart(CRC16_INIT);
+}
+
+#if CRC_HW_EN
+/****************************************************************************************
+* CrcStart - Loads the seed. TOT is cleared while it is written so the seed goes in as
+*            it is.
+****************************************************************************************/
+void CrcStart(INT16U seed) {
+    CrcDmaWait();
+    CRC0->CTRL = CRC_CTRL_WAS_MASK;
+    CRC0->DATA = seed;
+    CRC0->CTRL = CRC_CTRL_DATA;
+}
+
+/****************************************************************************************
+* CrcAddByte - An 8 bit write adds one byte
+****************************************************************************************/
+void CrcAddByte(INT8U byte) {
+    if (CrcDmaBusy != 0) {
+        CrcDmaWait();
+    } else {}
+    CRC0->ACCESS8BIT.DATALL = byte;
+}
+
+/****************************************************************************************
+* CrcAdd - Adds bytes up to a word boundary, then words, then the bytes left
+****************************************************************************************/
+void CrcAdd(const INT8U* data, INT32U bytes) {
+    CrcDmaWait();
+    while ((bytes != 0) && (((INT32U)data & 3U) != 0)) {
+        CRC0->ACCESS8BIT.DATALL = *data;
+        data++;
+        bytes--;
+    }
+    while (bytes >= 4U) {
+        CRC0->DATA = *(const INT32U*)data;
+        data += 4;
+        bytes -= 4U;
+    }
+    while (bytes != 0) {
+        CRC0->ACCESS8BIT.DATALL = *data;
+        data++;
+        bytes--;
+    }
+}
+
+/****************************************************************************************
+* CrcAddDma - The CPU adds bytes up to a word boundary and eDMA the words, one word a
+*             request so other channels get the bus between them. What does not fit one
+*             major loop is left to CrcDmaWait() with the ragged end.
+****************************************************************************************/
+void CrcAddDma(const INT8U* data, INT32U bytes) {
+#if CRC_DMA_EN
+    INT32U words;
+    if (bytes < CRC_DMA_MIN_BYTES) {
+        CrcAdd(data, bytes);
+    } else {
+        CrcDmaWait();
+        while (((INT32U)data & 3U) != 0) {
+            CRC0->ACCESS8BIT.DATALL = *data;
+            data++;
+            bytes--;
+        }
+        words = bytes / 4U;
+        if (words > CRC_DMA_MAX_WORDS) {
+            words = CRC_DMA_MAX_WORDS;
+        } else {}
+        CrcTail = data + (words * 4U);
+        CrcTailBytes = bytes - (words * 4U);
+        DMA0->TCD[CRC_DMA_CH].SADDR = (INT32U)data;
+        DMA0->TCD[CRC_DMA_CH].SOFF = 4;
+        DMA0->TCD[CRC_DMA_CH].ATTR = DMA_ATTR_SSIZE(2) | DMA_ATTR_DSIZE(2);
+        DMA0->TCD[CRC_DMA_CH].NBYTES_MLNO = 4;
+        DMA0->TCD[CRC_DMA_CH].SLAST = 0;
+        DMA0->TCD[CRC_DMA_CH].DADDR = (INT32U)&CRC0->DATA;
+        DMA0->TCD[CRC_DMA_CH].DOFF = 0;
+        DMA0->TCD[CRC_DMA_CH].CITER_ELINKNO = (INT16U)words;
+        DMA0->TCD[CRC_DMA_CH].BITER_ELINKNO = (INT16U)words;
+        DMA0->TCD[CRC_DMA_CH].DLAST_SGA = 0;
+        DMA0->TCD[CRC_DMA_CH].CSR = DMA_CSR_DREQ(1);    // Request disabled at the end
+        DMAMUX->CHCFG[CRC_DMA_CH] = DMAMUX_CHCFG_ENBL(1) | DMAMUX_CHCFG_SOURCE(CRC_DMA_SOURCE);
+        CrcDmaBusy = 1;
+        DMA0->SERQ = DMA_SERQ_SERQ(CRC_DMA_CH);
+    }
+#else
+    CrcAdd(data, bytes);
+#endif
+}
+
+/****************************************************************************************
+* CrcResult - Waits for CrcAddDma() and reads the CRC
+****************************************************************************************/
+INT16U CrcResult(void) {
+    CrcDmaWait();
+    return (INT16U)CRC0->DATA;
+}
+
+/****************************************************************************************
+* CrcDmaWait - Waits for the CrcAddDma() transfer, if any, and adds what it left. A
+*              block longer than one major loop restarts the eDMA on the rest, so this
+*              loops until no transfer is running and no bytes are left.
+****************************************************************************************/
+static void CrcDmaWait(void) {
+#if CRC_DMA_EN
+    while (CrcDmaBusy != 0) {
+        while ((DMA0->TCD[CRC_DMA_CH].CSR & DMA_CSR_DONE_MASK) == 0) {}
+        DMA0->CDNE = DMA_CDNE_CDNE(CRC_DMA_CH);
+        DMAMUX->CHCFG[CRC_DMA_CH] = 0;
+        CrcDmaBusy = 0;
+        CrcAddDma(CrcTail, CrcTailBytes);   // Sets CrcDmaBusy again if the rest is long
+    }
+#endif
+}
+#else
+/****************************************************************************************
+* CrcStart, CrcAddByte, CrcAdd, CrcAddDma, CrcResult - Software CRC for the host build
+****************************************************************************************/
+void CrcStart(INT16U seed) {
+    CrcSwState = seed;
+}
+
+void CrcAddByte(INT8U byte) {
+    CrcSwState = CrcSwByte(CrcSwState, byte);
+}
+
+void CrcAdd(const INT8U* data, INT32U bytes) {
+    CrcSwState = Crc16Sw(CrcSwState, data, bytes);
+}
+
+void CrcAddDma(const INT8U* data, INT32U bytes) {
+    CrcSwState = Crc16Sw(CrcSwState, data, bytes);
+}
+
+INT16U CrcResult(void) {
+    return CrcSwState;
+}
+#endif
+
+/****************************************************************************************
+* Crc16Sw - Software CRC of a block
+****************************************************************************************/
+INT16U Crc16Sw(INT16U crc, const INT8U* data, INT32U bytes) {
+    for (INT32U i = 0; i < bytes; i++) {
+        crc = CrcSwByte(crc, data[i]);
+    }
+    return crc;
+}
+
+/****************************************************************************************
+* CrcSelfTest - The test block is a byte pattern at offsets 0 to 3 of a word aligned
+*               buffer. It is long enough for the eDMA feed.
+****************************************************************************************/
+INT8U CrcSelfTest(void) {
+    INT32U buf[(CRC_TEST_BYTES + 3U + 3U) / 4U];
+    INT8U* bytes = (INT8U*)buf;
+    INT8U fail = 0;
+    INT16U sw;
+    INT16U seed = CRC16_INIT;
+    for (INT16U i = 0; i < (CRC_TEST_BYTES + 3U); i++) {
+        seed = (INT16U)((seed * 25173U) + 13849U);
+        bytes[i] = (INT8U)(seed >> 8);
+    }
+    if (Crc16Sw(CRC16_INIT, CrcCheckData, sizeof(CrcCheckData)) != CRC16_CHECK) {
+        fail = 1;
+    } else {}
+    CrcStart(CRC16_INIT);
+    CrcAdd(CrcCheckData, sizeof(CrcCheckData));
+    if (CrcResult() != CRC16_CHECK) {
+        fail = 1;
+    } else {}
+    for (INT8U offset = 0; offset < 4U; offset++) {
+        sw = Crc16Sw(CRC16_INIT, &bytes[offset], CRC_TEST_BYTES);
+        CrcStart(CRC16_INIT);
+        CrcAdd(&bytes[offset], CRC_TEST_BYTES);
+        if (CrcResult() != sw) {
+            fail = 1;
+        } else {}
+        CrcStart(CRC16_INIT);
+        CrcAddDma(&bytes[offset], CRC_TEST_BYTES);
+        if (CrcResult() != sw) {
+            fail = 1;
+        } else {}
+        CrcStart(CRC16_INIT);
+        CrcAddByte(bytes[offset]);
+        CrcAdd(&bytes[offset + 1U], CRC_TEST_SPLIT - 1U);
+        CrcStart(CrcResult());
+        CrcAddDma(&bytes[offset + CRC_TEST_SPLIT], CRC_TEST_BYTES - CRC_TEST_SPLIT);
+        if (CrcResult() != sw) {
+            fail = 1;
+        } else {}
+    }
+    return fail;
+}
+
+/****************************************************************************************
+* CrcSwByte - Adds one byte to a CRC-16/CCITT-FALSE, high nibble first
+****************************************************************************************/
+static INT16U CrcSwByte(INT16U crc, INT8U byte) {
+    crc = (INT16U)((crc << 4) ^ CrcTable[((crc >> 12) ^ (byte >> 4)) & 0x0FU]);
+    crc = (INT16U)((crc << 4) ^ CrcTable[((crc >> 12) ^ byte) & 0x0FU]);
+    return crc;
+}
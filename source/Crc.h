@@ -0,0 +1,76 @@
+/****************************************************************************************
+ * DESCRIPTION: CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF, not reflected, no final
+ *              XOR) on the K22 CRC module, with an optional eDMA feed for long blocks.
+ *              With CRC_HW_EN 0 the same functions run the software CRC, for a host
+ *              build. CrcSelfTest() checks the module against the software bit for bit.
+ * AUTHOR: Neal Crawford
+ * HISTORY: Started 10/16/2026
+ ***************************************************************************************
+ * The module holds one CRC at a time: CrcStart(), then any mix of CrcAddByte(),
+ * CrcAdd() and CrcAddDma(), then CrcResult(). Main loop only, not reentrant.
+ * A result passed to CrcStart() continues the CRC with more data.
+ ***************************************************************************************/
+#ifndef CRC_DEF
+#define CRC_DEF
+
+#ifndef CRC_HW_EN
+#define CRC_HW_EN 1             // 0 for a host build, the software CRC only
+#endif
+
+/* eDMA feed for CrcAddDma(). Channel CRC_DMA_CH is started by the DMAMUX always enabled
+ * source and given a lower priority than ACCEL_DMA_CH, so the FXOS reads wait at most one
+ * word. 0 feeds CrcAddDma() blocks from the CPU. */
+#define CRC_DMA_EN        1
+#define CRC_DMA_CH        1U
+#define CRC_DMA_SOURCE    60U   // DMAMUX always enabled
+#define CRC_DMA_MIN_BYTES 64U   // Shorter blocks are fed by the CPU
+
+#define CRC16_INIT        0xFFFFU
+#define CRC16_CHECK       0x29B1U   // CRC of "123456789"
+
+/****************************************************************************************
+* CrcInit - Clocks the CRC module and the eDMA channel
+****************************************************************************************/
+void CrcInit(void);
+
+/****************************************************************************************
+* CrcStart - Starts a CRC, waiting for a CrcAddDma() still running
+*   seed: CRC16_INIT, or a CrcResult() to continue
+****************************************************************************************/
+void CrcStart(INT16U seed);
+
+/****************************************************************************************
+* CrcAddByte, CrcAdd - Add one byte or a block to the CRC
+****************************************************************************************/
+void CrcAddByte(INT8U byte);
+void CrcAdd(const INT8U* data, INT32U bytes);
+
+/****************************************************************************************
+* CrcAddDma - Adds a block by eDMA and returns at once. The block must not change until
+*             CrcResult() or the next CrcStart(), CrcAddByte() or CrcAdd(), which wait for
+*             the transfer to finish. A transfer is at most 0x7FFF words, the wait runs
+*             the rest of a longer block before it returns.
+****************************************************************************************/
+void CrcAddDma(const INT8U* data, INT32U bytes);
+
+/****************************************************************************************
+* CrcResult - The CRC of the data added since CrcStart()
+****************************************************************************************/
+INT16U CrcResult(void);
+
+/****************************************************************************************
+* Crc16Sw - Software CRC, 4 bits at a time from a 32 byte table. Used for the host build
+*           and by CrcSelfTest().
+*   crc: CRC16_INIT, or a previous result to continue
+****************************************************************************************/
+INT16U Crc16Sw(INT16U crc, const INT8U* data, INT32U bytes);
+
+/****************************************************************************************
+* CrcSelfTest - Runs the check string and a test block at each alignment through the
+*               software CRC and, with CRC_HW_EN, through CrcAdd(), CrcAddDma() and a
+*               continued CRC
+*   return: 0 if every result matches, 1 otherwise
+****************************************************************************************/
+INT8U CrcSelfTest(void);
+
+#endif
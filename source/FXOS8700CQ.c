@@ -5,11 +5,17 @@
  * HISTORY: Started 11/24/14
  * Revision: 11/23/2015 TDM Modified for K65. Required GPIOs to be set to open-drain
  * Revision: 05/11/2020 by Neal Crawford for the FXOS8700CQ accelerometer on K22F
+ * Revision: 10/16/2026 Added interrupt/eDMA driven non-blocking burst reads
+ *                      Added FIFO mode with batched burst reads
+ *                      Added data-ready interrupt on INT1
+ *                      Added transient detection interrupt on INT1
+ *                      I2C0 SCL divider follows the bus clock profile
 *****************************************************************************************
 * Master header file
 ****************************************************************************************/
 #include "MCUType.h"
 #include "FXOS8700CQ.h"
+#include "K22FRDM_ClkCfg.h"
 
 /****************************************************************************************
 * Function prototypes (Private)
@@ -20,6 +26,63 @@ static void I2CStop(void);
 static void I2CStart(void);
 static void FXOSRegRd(INT8U raddr, INT8U* accelDataBuffer);
 static void FXOSRegWr(INT8U waddr, INT8U wdata);
+static INT8U FXOSRegRdAsync(INT8U raddr, INT8U* buffer, INT8U length, void (*done)(void));
+static void AccelSampleDone(void);
+static void FifoStatusDone(void);
+static void FifoDataDone(void);
+static void AsyncRxStart(void);
+static void AsyncRxFinish(INT8U* last);
+static void I2CBusClear(void);
+static void I2CDelay(INT32U ns);
+static INT8U I2CFreqDiv(INT32U busHz);
+static INT8U AccelClkNotify(INT8U phase);
+void I2C0_IRQHandler(void);
+void DMA0_IRQHandler(void);
+
+/****************************************************************************************
+* Non-blocking transfer states
+****************************************************************************************/
+#define ASYNC_IDLE      0U
+#define ASYNC_ADDR_WR   1U      /* Device address + W' is being sent                   */
+#define ASYNC_REG       2U      /* Register address is being sent                      */
+#define ASYNC_ADDR_RD   3U      /* Repeated start, device address + R is being sent    */
+#define ASYNC_RX_DMA    4U      /* eDMA is moving all but the last byte                */
+#define ASYNC_RX_LAST   5U      /* Last byte, NACKed, is being received                */
+#define ASYNC_RX_EXTRA  6U      /* Last byte was ACKed, one NACKed byte is clocked out */
+
+static volatile INT8U AsyncState = ASYNC_IDLE;
+static INT8U AsyncReg;
+static INT8U* AsyncBuffer;
+static INT8U AsyncLength;
+static void (*AsyncDone)(void);
+static ACCEL_SAMPLE_CB SampleCallback;
+static INT8U SampleBuffer[7];
+static INT8U FifoBuffer[FXOS_FIFO_SIZE * 6U];
+static INT8U FifoStatus;
+static INT16U FifoOverflows;
+static INT16U SampleOverwrites;
+static INT8U TransientSrc;
+static INT8U AsyncExtra;               /* Byte clocked out after a late last byte ACK     */
+
+/****************************************************************************************
+* I2C0 SCL dividers by F[ICR], MULT = 1. SCL is the bus clock over the divider.
+****************************************************************************************/
+#define I2C_SCL_MAX_HZ 400000U
+
+/****************************************************************************************
+* I2C0 pins, PTB2 SCL and PTB3 SDA, as GPIO for the bus clear
+****************************************************************************************/
+#define I2C_SCL_PIN     2U
+#define I2C_SDA_PIN     3U
+#define I2C_HALF_CLK_NS 5000U   /* Bus clear SCL at 100KHz                              */
+#define I2C_STOP_NS     50000U  /* Time allowed for a Stop at the slowest SCL           */
+#define I2C_BUS_FREE_NS 1300U   /* Stop to Start bus free time, tBUF                    */
+static const INT16U I2CSclDivider[64] = {
+      20,   22,   24,   26,   28,   30,   34,   40,   28,   32,   36,   40,   44,   48,   56,   68,
+      48,   56,   64,   72,   80,   88,  104,  128,   80,   96,  112,  128,  144,  160,  192,  240,
+     160,  192,  224,  256,  288,  320,  384,  480,  320,  384,  448,  512,  576,  640,  768,  960,
+     640,  768,  896, 1024, 1152, 1280, 1536, 1920, 1280, 1536, 1792, 2048, 2304, 2560, 3072, 3840
+};
 
 /****************************************************************************************
 * AccelInit - Initialize I2C for the FXOS8700CQ
@@ -31,7 +94,11 @@ void AccelInit(void){
     PORTB->PCR[2] = PORT_PCR_MUX(2)|PORT_PCR_ODE(1);  /* Configure GPIO for I2C0         */
     PORTB->PCR[3] = PORT_PCR_MUX(2)|PORT_PCR_ODE(1);  /* and open drain                  */
 
-    I2C0->F  = 0x1B;                /* Set SCL to 390.625KHz              */
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;  /* DWT cycle counter for I2CDelay() */
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    I2C0->F  = I2CFreqDiv(ClkGetBusHz());   /* SCL at most 400KHz           */
+    (void)ClkAddNotifier(AccelClkNotify);
     I2C0->C1 |= I2C_C1_IICEN(1);    /* Enable I2C0 and interrupts    */
     I2C0->S |= I2C_S_IICIF(1);                 /* Clear IICIF flag                    */
 
@@ -43,6 +110,14 @@ void AccelInit(void){
     //FXOSRegWr(FXOS_HP_FILTER_CUTOFF, 0x02); // HPF cutoff at 4 Hz.
     /* Breakpoint immediately below this line allows for confirmation that accelerometer is not in a "stuck" state out of startup  */
     FXOSRegWr(FXOS_CTRL_REG1, 0x05); // Set 800 Hz ODR, Normal 16-bit read, low noise mode, bring accelerometer out of standby
+
+    /* eDMA channel for non-blocking reads, requests come from I2C0 once C1[DMAEN] is set */
+    SIM->SCGC6 |= SIM_SCGC6_DMAMUX_MASK;
+    SIM->SCGC7 |= SIM_SCGC7_DMA_MASK;
+    DMAMUX->CHCFG[ACCEL_DMA_CH] = 0;
+    DMAMUX->CHCFG[ACCEL_DMA_CH] = DMAMUX_CHCFG_ENBL(1) | DMAMUX_CHCFG_SOURCE(ACCEL_DMA_SOURCE);
+    NVIC_EnableIRQ(DMA0_IRQn);
+    NVIC_EnableIRQ(I2C0_IRQn);
 }
 
 /****************************************************************************************
@@ -110,7 +185,7 @@ static void I2CRd(INT8U* accelDataBuffer){
 static void I2CStop(void){
     I2C0->C1 &= (INT8U)(~I2C_C1_MST_MASK);
     I2C0->C1 &= (INT8U)(~I2C_C1_TX_MASK);
-    for(INT8U i = 0; i < 250; i++ ){} // Delay for bus free time, 1.3us
+    I2CDelay(I2C_BUS_FREE_NS);
 }
 
 /****************************************************************************************
@@ -135,3 +210,370 @@ void AccelSampleTask(ACCEL_DATA_3D* accelData) {
     accelData->z = (INT16S)(((dataBuffer[5] << 8) | dataBuffer[6]))>> 2;
 
 }
+
+/****************************************************************************************
+* AccelSampleStart - Start a non-blocking status+XYZ burst read. callback is called from
+*                    interrupt context with the converted sample when it is done.
+*   return: 1 if the read was started, 0 if a read is still in progress
+****************************************************************************************/
+INT8U AccelSampleStart(ACCEL_SAMPLE_CB callback) {
+    INT8U started = 0;
+    if (AsyncState == ASYNC_IDLE) {     // The read in flight keeps its callback
+        SampleCallback = callback;
+        started = FXOSRegRdAsync(FXOS_STATUS, SampleBuffer, 7, AccelSampleDone);
+    } else {}
+    return started;
+}
+
+/****************************************************************************************
+* AccelSampleDone - Completion of the AccelSampleStart() read, interrupt context
+****************************************************************************************/
+static void AccelSampleDone(void) {
+    ACCEL_DATA_3D accelData;
+    if ((SampleBuffer[0] & FXOS_ZYXOW_MASK) != 0) {
+        SampleOverwrites++;
+    } else {}
+    accelData.x = (INT16S)(((SampleBuffer[1] << 8) | SampleBuffer[2]))>> 2;
+    accelData.y = (INT16S)(((SampleBuffer[3] << 8) | SampleBuffer[4]))>> 2;
+    accelData.z = (INT16S)(((SampleBuffer[5] << 8) | SampleBuffer[6]))>> 2;
+    SampleCallback(&accelData);
+}
+
+/****************************************************************************************
+* FXOSRegRdAsync - Start a non-blocking burst read from FXOS registers. The address
+*                  phase is run from I2C0_IRQHandler(), the data phase by eDMA.
+* Parameters:
+*   raddr is the first register address to read
+*   buffer receives length bytes, length must be at least 1
+*   done is called from interrupt context when the last byte is in buffer
+*   return value is 1 if started, 0 if a transfer is still in progress
+****************************************************************************************/
+static INT8U FXOSRegRdAsync(INT8U raddr, INT8U* buffer, INT8U length, void (*done)(void)) {
+    INT8U started = 0;
+    if (AsyncState == ASYNC_IDLE) {
+        AsyncReg = raddr;
+        AsyncBuffer = buffer;
+        AsyncLength = length;
+        AsyncDone = done;
+        AsyncState = ASYNC_ADDR_WR;
+        I2C0->S |= I2C_S_IICIF(1);          /* Clear any stale flag                    */
+        I2C0->C1 |= I2C_C1_IICIE_MASK;
+        I2CStart();
+        I2C0->D = (FXOS_ADDR<<1)|WR;        /* Send FXOS address & W/R' bit            */
+        started = 1;
+    } else {}
+    return started;
+}
+
+/****************************************************************************************
+* AsyncRxStart - Switch to master receive and hand all but the last byte to eDMA
+****************************************************************************************/
+static void AsyncRxStart(void) {
+    INT8U din;
+    I2C0->C1 &= (INT8U)(~I2C_C1_TX_MASK);          /* Set to master receive mode          */
+    if (AsyncLength == 1) {
+        I2C0->C1 |= I2C_C1_TXAK_MASK;               /* Only byte is NACKed                 */
+        AsyncState = ASYNC_RX_LAST;
+    } else {
+        I2C0->C1 &= ~I2C_C1_TXAK_MASK;              /* Set to ack on read                  */
+        I2C0->C1 &= (INT8U)(~I2C_C1_IICIE_MASK);    /* eDMA takes over until the last byte */
+        DMA0->TCD[ACCEL_DMA_CH].SADDR = (INT32U)&I2C0->D;
+        DMA0->TCD[ACCEL_DMA_CH].SOFF = 0;
+        DMA0->TCD[ACCEL_DMA_CH].ATTR = DMA_ATTR_SSIZE(0) | DMA_ATTR_DSIZE(0);
+        DMA0->TCD[ACCEL_DMA_CH].NBYTES_MLNO = 1;
+        DMA0->TCD[ACCEL_DMA_CH].SLAST = 0;
+        DMA0->TCD[ACCEL_DMA_CH].DADDR = (INT32U)AsyncBuffer;
+        DMA0->TCD[ACCEL_DMA_CH].DOFF = 1;
+        DMA0->TCD[ACCEL_DMA_CH].CITER_ELINKNO = (INT16U)(AsyncLength - 1U);
+        DMA0->TCD[ACCEL_DMA_CH].BITER_ELINKNO = (INT16U)(AsyncLength - 1U);
+        DMA0->TCD[ACCEL_DMA_CH].DLAST_SGA = 0;
+        DMA0->TCD[ACCEL_DMA_CH].CSR = DMA_CSR_INTMAJOR(1) | DMA_CSR_DREQ(1);
+        DMA0->SERQ = DMA_SERQ_SERQ(ACCEL_DMA_CH);
+        I2C0->C1 |= I2C_C1_DMAEN_MASK;
+        AsyncState = ASYNC_RX_DMA;
+    }
+    din = I2C0->D;                                  /* Dummy read to generate clock cycles */
+    (void)din;
+}
+
+/****************************************************************************************
+* I2C0_IRQHandler - Steps the non-blocking read through its address phase and
+*                   finishes the last byte.
+****************************************************************************************/
+void I2C0_IRQHandler(void) {
+    I2C0->S |= I2C_S_IICIF(1);                      /* Clear IICIF flag                    */
+    switch (AsyncState) {
+    case ASYNC_ADDR_WR:
+        I2C0->D = AsyncReg;                         /* Send register address               */
+        AsyncState = ASYNC_REG;
+        break;
+    case ASYNC_REG:
+        I2C0->C1 |= I2C_C1_RSTA_MASK;               /* Repeated Start                      */
+        I2C0->D = (FXOS_ADDR<<1)|RD;                /* Send FXOS address & W/R' bit        */
+        AsyncState = ASYNC_ADDR_RD;
+        break;
+    case ASYNC_ADDR_RD:
+        AsyncRxStart();
+        break;
+    case ASYNC_RX_LAST:
+        AsyncRxFinish(&AsyncBuffer[AsyncLength - 1U]);
+        break;
+    case ASYNC_RX_EXTRA:
+        AsyncRxFinish(&AsyncExtra);
+        break;
+    default:
+        break;
+    }
+}
+
+/****************************************************************************************
+* AsyncRxFinish - The NACKed byte is in, send Stop and hand the read to AsyncDone.
+*                 Bus free time is covered by the time to the next request.
+*   last receives the byte
+****************************************************************************************/
+static void AsyncRxFinish(INT8U* last) {
+    I2C0->C1 &= (INT8U)(~I2C_C1_IICIE_MASK);
+    I2C0->C1 &= (INT8U)(~I2C_C1_MST_MASK);          /* Send Stop                           */
+    I2C0->C1 &= (INT8U)(~I2C_C1_TX_MASK);
+    *last = I2C0->D;                                /* Read final byte that was clocked in */
+    AsyncState = ASYNC_IDLE;
+    AsyncDone();
+}
+
+/****************************************************************************************
+* DMA0_IRQHandler - eDMA has read all but the last byte. Reading the second to last
+*                   byte already started the last one, so NACK it and let the I2C0
+*                   interrupt finish. If this runs more than a byte time late the last
+*                   byte is already in and was ACKed, TCF shows it. The FXOS then holds
+*                   SDA for another byte, so that byte is clocked out with a NACK and
+*                   dropped before the Stop.
+****************************************************************************************/
+void DMA0_IRQHandler(void) {
+    DMA0->CINT = DMA_CINT_CINT(ACCEL_DMA_CH);
+    I2C0->C1 |= I2C_C1_TXAK_MASK;                   /* Send NACK to end transmission       */
+    I2C0->C1 &= (INT8U)(~I2C_C1_DMAEN_MASK);
+    I2C0->S |= I2C_S_IICIF(1);                      /* Flag left set by the eDMA bytes     */
+    if ((I2C0->S & I2C_S_TCF_MASK) != 0) {
+        AsyncBuffer[AsyncLength - 1U] = I2C0->D;    /* Starts the extra byte               */
+        I2C0->S |= I2C_S_IICIF(1);                  /* Flag set by the last byte           */
+        AsyncState = ASYNC_RX_EXTRA;
+    } else {
+        AsyncState = ASYNC_RX_LAST;
+    }
+    I2C0->C1 |= I2C_C1_IICIE_MASK;
+}
+
+/****************************************************************************************
+* AccelReadAbort - Drop a non-blocking read that has stopped making progress. Stops the
+*                  eDMA and I2C0 interrupts, sends a Stop and, if the FXOS still holds
+*                  SDA low, clears the bus by hand.
+****************************************************************************************/
+void AccelReadAbort(void) {
+    DMA0->CERQ = DMA_CERQ_CERQ(ACCEL_DMA_CH);
+    DMA0->CINT = DMA_CINT_CINT(ACCEL_DMA_CH);
+    I2C0->C1 &= (INT8U)(~(I2C_C1_IICIE_MASK | I2C_C1_DMAEN_MASK));
+    I2C0->C1 |= I2C_C1_TXAK_MASK;
+    I2C0->C1 &= (INT8U)(~I2C_C1_MST_MASK);          /* Send Stop                           */
+    I2C0->C1 &= (INT8U)(~I2C_C1_TX_MASK);
+    I2CDelay(I2C_STOP_NS);
+    if ((I2C0->S & I2C_S_BUSY_MASK) != 0) {
+        I2CBusClear();
+    } else {}
+    I2C0->S |= I2C_S_IICIF(1) | I2C_S_ARBL(1);
+    NVIC_ClearPendingIRQ(I2C0_IRQn);
+    AsyncState = ASYNC_IDLE;
+}
+
+/****************************************************************************************
+* I2CBusClear - Takes the pins as open drain GPIO, clocks SCL until the slave lets SDA
+*               go, up to nine clocks, then drives a Stop and gives the pins back to I2C0.
+****************************************************************************************/
+static void I2CBusClear(void) {
+    INT8U clocks;
+    I2C0->C1 &= (INT8U)(~I2C_C1_IICEN_MASK);
+    GPIOB->PSOR = (1U << I2C_SCL_PIN) | (1U << I2C_SDA_PIN);   /* Released              */
+    GPIOB->PDDR |= (1U << I2C_SCL_PIN) | (1U << I2C_SDA_PIN);
+    PORTB->PCR[I2C_SCL_PIN] = PORT_PCR_MUX(1)|PORT_PCR_ODE(1);
+    PORTB->PCR[I2C_SDA_PIN] = PORT_PCR_MUX(1)|PORT_PCR_ODE(1);
+    I2CDelay(I2C_HALF_CLK_NS);
+    for (clocks = 0; (clocks < 9U) && ((GPIOB->PDIR & (1U << I2C_SDA_PIN)) == 0); clocks++) {
+        GPIOB->PCOR = (1U << I2C_SCL_PIN);
+        I2CDelay(I2C_HALF_CLK_NS);
+        GPIOB->PSOR = (1U << I2C_SCL_PIN);
+        I2CDelay(I2C_HALF_CLK_NS);
+    }
+    GPIOB->PCOR = (1U << I2C_SCL_PIN);              /* Stop, SDA rises while SCL is high   */
+    GPIOB->PCOR = (1U << I2C_SDA_PIN);
+    I2CDelay(I2C_HALF_CLK_NS);
+    GPIOB->PSOR = (1U << I2C_SCL_PIN);
+    I2CDelay(I2C_HALF_CLK_NS);
+    GPIOB->PSOR = (1U << I2C_SDA_PIN);
+    I2CDelay(I2C_HALF_CLK_NS);
+    PORTB->PCR[I2C_SCL_PIN] = PORT_PCR_MUX(2)|PORT_PCR_ODE(1);
+    PORTB->PCR[I2C_SDA_PIN] = PORT_PCR_MUX(2)|PORT_PCR_ODE(1);
+    I2C0->C1 |= I2C_C1_IICEN(1);
+}
+
+/****************************************************************************************
+* I2CDelay - Waits at least ns nanoseconds on the DWT cycle counter at the current core
+*            clock
+****************************************************************************************/
+static void I2CDelay(INT32U ns) {
+    INT32U start = DWT->CYCCNT;
+    INT32U cycles = (((ClkGetCoreHz() + 999999U) / 1000000U) * ns + 999U) / 1000U;  /* Rounded up */
+    while ((DWT->CYCCNT - start) < cycles) {}
+}
+
+/****************************************************************************************
+* AccelFifoInit - Enable the 32-sample FIFO in circular mode. The sensor must be in
+*                 standby to change F_SETUP.
+****************************************************************************************/
+void AccelFifoInit(INT8U watermark) {
+    FifoOverflows = 0;
+    FXOSRegWr(FXOS_CTRL_REG1, 0x00); // Standby
+    FXOSRegWr(FXOS_F_SETUP, (INT8U)(FXOS_F_MODE_CIRCULAR | (watermark & FXOS_F_CNT_MASK)));
+    FXOSRegWr(FXOS_CTRL_REG1, 0x05); // 800 Hz ODR, low noise mode, active
+}
+
+/****************************************************************************************
+* AccelFifoDrainStart - Start a non-blocking drain of every sample in the FIFO.
+*   return: 1 if the drain was started, 0 if a read is still in progress
+****************************************************************************************/
+INT8U AccelFifoDrainStart(ACCEL_SAMPLE_CB callback) {
+    INT8U started = 0;
+    if (AsyncState == ASYNC_IDLE) {     // The drain in flight keeps its callback
+        SampleCallback = callback;
+        started = FXOSRegRdAsync(FXOS_F_STATUS, &FifoStatus, 1, FifoStatusDone);
+    } else {}
+    return started;
+}
+
+/****************************************************************************************
+* AccelFifoOverflows - Number of drains that found the FIFO overflowed
+****************************************************************************************/
+INT16U AccelFifoOverflows(void) {
+    return FifoOverflows;
+}
+
+/****************************************************************************************
+* FifoStatusDone - F_STATUS is in, read all stored samples in one burst. The FXOS rolls
+*                  the address from 0x06 back to 0x01 in FIFO mode. Interrupt context.
+****************************************************************************************/
+static void FifoStatusDone(void) {
+    INT8U count = FifoStatus & FXOS_F_CNT_MASK;
+    if ((FifoStatus & FXOS_F_OVF_MASK) != 0) {
+        FifoOverflows++;
+    } else {}
+    if (count != 0) {
+        I2CDelay(I2C_BUS_FREE_NS);          // The Stop was just sent
+        (void)FXOSRegRdAsync(FXOS_OUT_X_MSB, FifoBuffer, (INT8U)(count * 6U), FifoDataDone);
+    } else {}
+}
+
+/****************************************************************************************
+* FifoDataDone - Hand each drained sample to the callback, oldest first. Interrupt context.
+****************************************************************************************/
+static void FifoDataDone(void) {
+    ACCEL_DATA_3D accelData;
+    INT8U* sample = FifoBuffer;
+    INT8U* end = &FifoBuffer[AsyncLength];
+    while (sample < end) {
+        accelData.x = (INT16S)(((sample[0] << 8) | sample[1]))>> 2;
+        accelData.y = (INT16S)(((sample[2] << 8) | sample[3]))>> 2;
+        accelData.z = (INT16S)(((sample[4] << 8) | sample[5]))>> 2;
+        SampleCallback(&accelData);
+        sample += 6;
+    }
+}
+
+/****************************************************************************************
+* AccelDrdyInit - Route the data-ready interrupt to INT1 so each new 800 Hz sample is read
+*                 exactly once. The sensor must be in standby to change CTRL_REG4/5.
+****************************************************************************************/
+void AccelDrdyInit(void) {
+    SampleOverwrites = 0;
+    FXOSRegWr(FXOS_CTRL_REG1, 0x00); // Standby
+    FXOSRegWr(FXOS_CTRL_REG3, 0x00); // INT pins active low, push-pull
+    FXOSRegWr(FXOS_CTRL_REG4, FXOS_INT_EN_DRDY);
+    FXOSRegWr(FXOS_CTRL_REG5, FXOS_INT_CFG_DRDY);
+
+    SIM->SCGC5 |= SIM_SCGC5_PORTD_MASK;
+    ACCEL_INT1_PORT->PCR[ACCEL_INT1_PIN] = PORT_PCR_MUX(1) | PORT_PCR_IRQC(0xA) | PORT_PCR_ISF_MASK; // GPIO, falling edge
+    NVIC_ClearPendingIRQ(ACCEL_INT1_IRQ);
+    NVIC_EnableIRQ(ACCEL_INT1_IRQ);
+
+    FXOSRegWr(FXOS_CTRL_REG1, 0x05); // 800 Hz ODR, low noise mode, active
+}
+
+/****************************************************************************************
+* I2CFreqDiv - I2C0 F value for the fastest SCL up to I2C_SCL_MAX_HZ
+****************************************************************************************/
+static INT8U I2CFreqDiv(INT32U busHz) {
+    INT8U icr;
+    INT8U best = 0x3FU;
+    for (icr = 0; icr < 64U; icr++) {
+        if (((busHz / I2CSclDivider[icr]) <= I2C_SCL_MAX_HZ) && (I2CSclDivider[icr] < I2CSclDivider[best])) {
+            best = icr;
+        } else {}
+    }
+    return (INT8U)(I2C_F_MULT(0) | I2C_F_ICR(best));
+}
+
+/****************************************************************************************
+* AccelClkNotify - Clock profile change. The bus clock can not change under a transfer,
+*                  SCL would leave the divider's range.
+****************************************************************************************/
+static INT8U AccelClkNotify(INT8U phase) {
+    INT8U ready = 1;
+    if (phase == CLK_NOTIFY_PRE) {
+        ready = ((AsyncState == ASYNC_IDLE) && ((I2C0->S & I2C_S_BUSY_MASK) == 0)) ? 1U : 0U;
+    } else {
+        I2C0->F = I2CFreqDiv(ClkGetBusHz());
+    }
+    return ready;
+}
+
+/****************************************************************************************
+* AccelOverwrites - Number of reads that found an overwritten sample
+****************************************************************************************/
+INT16U AccelOverwrites(void) {
+    return SampleOverwrites;
+}
+
+/****************************************************************************************
+* AccelTransientInit - Enable the latched transient detector on INT1. The detector runs
+*                      on the sensor's high-pass filtered data, so gravity does not count
+*                      towards the threshold. The sensor must be in standby to change
+*                      CTRL_REG4/5.
+****************************************************************************************/
+void AccelTransientInit(INT8U threshold, INT8U count) {
+    FXOSRegWr(FXOS_CTRL_REG1, 0x00); // Standby
+    FXOSRegWr(FXOS_CTRL_REG3, 0x00); // INT pins active low, push-pull
+    FXOSRegWr(FXOS_TRANSIENT_CFG, FXOS_TRANSIENT_ELE | FXOS_TRANSIENT_XYZ_EFE);
+    FXOSRegWr(FXOS_TRANSIENT_THS, (INT8U)(threshold & FXOS_TRANSIENT_THS_MASK));
+    FXOSRegWr(FXOS_TRANSIENT_COUNT, count);
+    FXOSRegWr(FXOS_CTRL_REG4, FXOS_INT_EN_TRANS);
+    FXOSRegWr(FXOS_CTRL_REG5, FXOS_INT_CFG_TRANS); // Transient on INT1, PTD0 is an LLWU pin
+
+    SIM->SCGC5 |= SIM_SCGC5_PORTD_MASK;
+    ACCEL_INT1_PORT->PCR[ACCEL_INT1_PIN] = PORT_PCR_MUX(1) | PORT_PCR_ISF_MASK; // GPIO, interrupt off
+    NVIC_ClearPendingIRQ(ACCEL_INT1_IRQ);
+    NVIC_EnableIRQ(ACCEL_INT1_IRQ);
+
+    FXOSRegWr(FXOS_CTRL_REG1, 0x05); // 800 Hz ODR, low noise mode, active
+}
+
+/****************************************************************************************
+* AccelTransientAck - Start a non-blocking read of TRANSIENT_SRC to release INT1
+*   return: 1 if the read was started, 0 if a read is still in progress
+****************************************************************************************/
+INT8U AccelTransientAck(void (*done)(void)) {
+    return FXOSRegRdAsync(FXOS_TRANSIENT_SRC, &TransientSrc, 1, done);
+}
+
+/****************************************************************************************
+* AccelReadBusy - 1 while a non-blocking read is in progress
+****************************************************************************************/
+INT8U AccelReadBusy(void) {
+    return (AsyncState != ASYNC_IDLE) ? 1U : 0U;
+}
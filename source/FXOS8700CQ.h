@@ -14,6 +14,9 @@ typedef struct {
     INT16S z;
 } ACCEL_DATA_3D;
 
+/* Called from interrupt context when a non-blocking read completes */
+typedef void (*ACCEL_SAMPLE_CB)(ACCEL_DATA_3D* accelData);
+
 /************************************************************************
 * Public Functions
 *************************************************************************
@@ -23,6 +26,94 @@ void AccelInit(void);
 
 void AccelSampleTask(ACCEL_DATA_3D* accelData);
 
+/************************************************************************
+* AccelSampleStart - Start a non-blocking status+XYZ burst read. The I2C0
+*                    interrupt and eDMA channel ACCEL_DMA_CH run the transfer
+*                    and callback is called with the sample when it is done.
+*   return: 1 if the read was started, 0 if a read is still in progress
+*************************************************************************/
+INT8U AccelSampleStart(ACCEL_SAMPLE_CB callback);
+
+/************************************************************************
+* AccelFifoInit - Enable the 32-sample FIFO in circular mode. The
+*                 watermark flag is set once watermark samples are stored.
+*************************************************************************/
+void AccelFifoInit(INT8U watermark);
+
+/************************************************************************
+* AccelFifoDrainStart - Start a non-blocking drain of every sample in the
+*                       FIFO. F_STATUS is read first, then all F_CNT
+*                       samples in one burst. callback is called once per
+*                       sample, oldest first, from interrupt context.
+*   return: 1 if the drain was started, 0 if a read is still in progress
+*************************************************************************/
+INT8U AccelFifoDrainStart(ACCEL_SAMPLE_CB callback);
+
+/************************************************************************
+* AccelFifoOverflows - Number of drains that found the FIFO overflowed,
+*                      meaning the oldest samples were overwritten
+*************************************************************************/
+INT16U AccelFifoOverflows(void);
+
+/************************************************************************
+* AccelDrdyInit - Route the data-ready interrupt to INT1 and configure
+*                 the INT1 pin for a falling edge PORT interrupt. The
+*                 PORT interrupt handler must clear ACCEL_INT1_PIN in ISFR.
+*************************************************************************/
+void AccelDrdyInit(void);
+
+/************************************************************************
+* AccelOverwrites - Number of reads whose STATUS[ZYXOW] showed that a
+*                   sample was overwritten before it was read
+*************************************************************************/
+INT16U AccelOverwrites(void);
+
+/************************************************************************
+* AccelTransientInit - Enable the high-pass filtered transient detector on
+*                      all three axes, latched and routed to INT1. The
+*                      INT1 pin is configured as a GPIO with its PORT
+*                      interrupt left off, see AccelTransientAck().
+*   threshold: in 63mg steps, 1 to 127
+*   count: debounce, in 1.25mS sample periods
+*************************************************************************/
+void AccelTransientInit(INT8U threshold, INT8U count);
+
+/************************************************************************
+* AccelTransientAck - Start a non-blocking read of TRANSIENT_SRC, which
+*                     releases the latched event and INT1. done is called
+*                     from interrupt context when the read completes.
+*   return: 1 if the read was started, 0 if a read is still in progress
+*************************************************************************/
+INT8U AccelTransientAck(void (*done)(void));
+
+/************************************************************************
+* AccelReadBusy - 1 while a non-blocking read is in progress
+*************************************************************************/
+INT8U AccelReadBusy(void);
+
+/************************************************************************
+* AccelReadAbort - Drops a non-blocking read that has stopped making
+*                  progress, frees the bus and returns the driver to idle.
+*                  The done callback of the dropped read is not called.
+*                  Call with the PIT and FXOS INT1 interrupts masked or
+*                  from their handlers.
+*************************************************************************/
+void AccelReadAbort(void);
+
+/*************************************************************************
+* FXOS INT1 pin on the FRDM-K22F, active low push-pull
+*************************************************************************/
+#define ACCEL_INT1_PORT     PORTD
+#define ACCEL_INT1_GPIO     PTD
+#define ACCEL_INT1_PIN      0U
+#define ACCEL_INT1_IRQ      PORTD_IRQn
+
+/*************************************************************************
+* eDMA channel used for I2C0 receive, DMAMUX source 18 is I2C0
+*************************************************************************/
+#define ACCEL_DMA_CH        0U
+#define ACCEL_DMA_SOURCE    18U
+
 /*************************************************************************
 * FXOS8700CQ Accelerometer Defines - Read/Write addresses.
 *************************************************************************/
@@ -30,6 +121,14 @@ void AccelSampleTask(ACCEL_DATA_3D* accelData);
 #define WR  0x00
 #define FXOS_ADDR        0x1c
 #define FXOS_STATUS      0x00
+#define FXOS_F_STATUS    0x00       /* STATUS reads as F_STATUS when the FIFO is enabled */
+#define FXOS_OUT_X_MSB   0x01
+#define FXOS_F_SETUP     0x09
+
+#define FXOS_TRANSIENT_CFG   0x1d
+#define FXOS_TRANSIENT_SRC   0x1e
+#define FXOS_TRANSIENT_THS   0x1f
+#define FXOS_TRANSIENT_COUNT 0x20
 
 #define FXOS_WHO_AM_I    0x0d
 #define FXOS_XYZ_DATA_CFG 0x0e
@@ -43,5 +142,20 @@ void AccelSampleTask(ACCEL_DATA_3D* accelData);
 #define FXOS_OFF_Y       0x30
 #define FXOS_OFF_Z       0x31
 
+#define FXOS_ZYXOW_MASK         0x80    /* STATUS: new sample overwrote an unread one */
+#define FXOS_INT_EN_DRDY        0x01    /* CTRL_REG4 */
+#define FXOS_INT_CFG_DRDY       0x01    /* CTRL_REG5: DRDY on INT1 */
+#define FXOS_INT_EN_TRANS       0x20    /* CTRL_REG4 */
+#define FXOS_INT_CFG_TRANS      0x20    /* CTRL_REG5: transient on INT1 */
+
+#define FXOS_TRANSIENT_ELE      0x10    /* TRANSIENT_CFG: latch events until SRC is read */
+#define FXOS_TRANSIENT_XYZ_EFE  0x0E    /* TRANSIENT_CFG: all three axes */
+#define FXOS_TRANSIENT_THS_MASK 0x7F
+
+#define FXOS_FIFO_SIZE          32U
+#define FXOS_F_MODE_CIRCULAR    0x40    /* F_SETUP[F_MODE] = 01, oldest sample overwritten */
+#define FXOS_F_OVF_MASK         0x80
+#define FXOS_F_CNT_MASK         0x3F
+
 #endif
 
@@ -0,0 +1,185 @@
+/****************************************************************************************
+ * DESCRIPTION: Framed binary telemetry over BasicIO, see Telemetry.h for the frame
+ *              layout.
+ * AUTHOR: Neal Crawford
+ * HISTORY: Started 10/16/2026
+*****************************************************************************************
+* Master header file
+****************************************************************************************/
+#include "MCUType.h"
+#include "BasicIO.h"
+#include "Telemetry.h"
+#include "Crc.h"
+
+#define TELEM_AXES 3U
+
+/* A first sample of 3 INT16S, then at most 3 varint bytes a difference */
+#define STREAM_MAX_BYTES ((TELEM_AXES * 2U) + ((TELEM_STREAM_SAMPLES - 1U) * TELEM_AXES * 3U))
+
+#if (TELEM_FRAME_SAMPLES == 0) || (TELEM_FRAME_SAMPLES > 255U) || (TELEM_STREAM_SAMPLES == 0) || (TELEM_STREAM_SAMPLES > 255U)
+#error "TELEM_FRAME_SAMPLES and TELEM_STREAM_SAMPLES must fit the 8 bit count field"
+#endif
+
+/****************************************************************************************
+* Function prototypes
+****************************************************************************************/
+static void TelemPutByte(INT8U byte);
+static void TelemPutHWord(INT16U hword);
+static void TelemPutHeader(INT8U type, INT16U rateHz, INT8U count, INT16U offset, INT16U total);
+static void TelemPutCrc(void);
+static void StreamPutVarint(INT32S delta);
+
+/****************************************************************************************
+* Static file variables
+****************************************************************************************/
+static INT8U TelemSeq;
+static INT16U TelemRate;
+static INT8U StreamBuf[STREAM_MAX_BYTES];
+static INT16U StreamLength;       // Payload bytes encoded
+static INT8U StreamCount;         // Samples encoded
+static INT16U StreamIndex;        // Stream index of the frame's first sample
+static INT16S StreamPrev[TELEM_AXES];
+static TELEM_STREAM_STATS StreamStats;
+
+/****************************************************************************************
+* TelemetrySendCapture - Sends samples of x, y and z as TELEM_TYPE_CAPTURE frames
+****************************************************************************************/
+void TelemetrySendCapture(const INT16S* x, const INT16S* y, const INT16S* z, INT16U samples, INT16U rateHz) {
+    INT16U offset = 0;
+    while (offset < samples) {
+        INT16U count = samples - offset;
+        if (count > TELEM_FRAME_SAMPLES) {
+            count = TELEM_FRAME_SAMPLES;
+        } else {}
+        TelemPutHeader(TELEM_TYPE_CAPTURE, rateHz, (INT8U)count, offset, samples);
+        for (INT16U i = offset; i < (offset + count); i++) {
+            TelemPutHWord((INT16U)x[i]);
+            TelemPutHWord((INT16U)y[i]);
+            TelemPutHWord((INT16U)z[i]);
+        }
+        TelemPutCrc();
+        offset += count;
+    }
+}
+
+/****************************************************************************************
+* TelemetryStreamStart - Starts a stream at sample index 0 and clears its statistics
+****************************************************************************************/
+void TelemetryStreamStart(INT16U rateHz) {
+    TelemRate = rateHz;
+    StreamLength = 0;
+    StreamCount = 0;
+    StreamIndex = 0;
+    StreamStats.rawBytes = 0;
+    StreamStats.sentBytes = 0;
+}
+
+/****************************************************************************************
+* TelemetryStreamSample - Encodes one sample. A frame starts with the sample itself, the
+*                         others are coded as differences from the sample before.
+****************************************************************************************/
+void TelemetryStreamSample(INT16S x, INT16S y, INT16S z) {
+    INT16S sample[TELEM_AXES];
+    sample[0] = x;
+    sample[1] = y;
+    sample[2] = z;
+    for (INT8U axis = 0; axis < TELEM_AXES; axis++) {
+        if (StreamCount == 0) {
+            StreamBuf[StreamLength] = (INT8U)sample[axis];
+            StreamBuf[StreamLength + 1U] = (INT8U)((INT16U)sample[axis] >> 8);
+            StreamLength += 2U;
+        } else {
+            StreamPutVarint((INT32S)sample[axis] - (INT32S)StreamPrev[axis]);
+        }
+        StreamPrev[axis] = sample[axis];
+    }
+    StreamCount++;
+    if (StreamCount == TELEM_STREAM_SAMPLES) {
+        TelemetryStreamFlush();
+    } else {}
+}
+
+/****************************************************************************************
+* TelemetryStreamFlush - Sends the samples encoded since the last frame, if any. eDMA
+*                       adds the payload to the CRC while it is being written.
+****************************************************************************************/
+void TelemetryStreamFlush(void) {
+    if (StreamCount != 0) {
+        TelemPutHeader(TELEM_TYPE_STREAM, TelemRate, StreamCount, StreamIndex, StreamLength);
+        CrcAddDma(StreamBuf, StreamLength);
+        for (INT16U i = 0; i < StreamLength; i++) {
+            BIOWrite((INT8C)StreamBuf[i]);
+        }
+        TelemPutCrc();
+        StreamStats.rawBytes += (INT32U)StreamCount * TELEM_AXES * 2U;
+        StreamStats.sentBytes += TELEM_HEADER_BYTES + StreamLength + 2U;   // Sync and header, payload, CRC
+        StreamIndex += StreamCount;
+        StreamCount = 0;
+        StreamLength = 0;
+    } else {}
+}
+
+/****************************************************************************************
+* TelemetryStreamStats - Bytes the stream would take as plain samples and bytes sent
+****************************************************************************************/
+void TelemetryStreamStats(TELEM_STREAM_STATS* stats) {
+    stats->rawBytes = StreamStats.rawBytes;
+    stats->sentBytes = StreamStats.sentBytes;
+}
+
+/****************************************************************************************
+* StreamPutVarint - Zigzag maps delta, so small differences of either sign stay small,
+*                   and appends it 7 bits a byte. A difference of two INT16S takes at
+*                   most 3 bytes.
+****************************************************************************************/
+static void StreamPutVarint(INT32S delta) {
+    INT32U zigzag = ((INT32U)delta << 1) ^ (INT32U)(delta >> 31);
+    while (zigzag >= 0x80U) {
+        StreamBuf[StreamLength] = (INT8U)((zigzag & 0x7FU) | 0x80U);
+        StreamLength++;
+        zigzag >>= 7;
+    }
+    StreamBuf[StreamLength] = (INT8U)zigzag;
+    StreamLength++;
+}
+
+/****************************************************************************************
+* TelemPutHeader - Sends the sync bytes and a header with the next sequence number and
+*                  starts the frame CRC, the sync bytes are not part of it
+****************************************************************************************/
+static void TelemPutHeader(INT8U type, INT16U rateHz, INT8U count, INT16U offset, INT16U total) {
+    BIOWrite((INT8C)TELEM_SYNC0);
+    BIOWrite((INT8C)TELEM_SYNC1);
+    CrcStart(CRC16_INIT);
+    TelemPutByte(type);
+    TelemPutByte(TelemSeq);
+    TelemPutHWord(rateHz);
+    TelemPutByte(TELEM_AXES);
+    TelemPutByte(count);
+    TelemPutHWord(offset);
+    TelemPutHWord(total);
+    TelemSeq++;
+}
+
+/****************************************************************************************
+* TelemPutByte, TelemPutHWord - Send a byte or a little-endian INT16U and add it to the
+*                               frame CRC
+****************************************************************************************/
+static void TelemPutByte(INT8U byte) {
+    BIOWrite((INT8C)byte);
+    CrcAddByte(byte);
+}
+
+static void TelemPutHWord(INT16U hword) {
+    TelemPutByte((INT8U)hword);
+    TelemPutByte((INT8U)(hword >> 8));
+}
+
+/****************************************************************************************
+* TelemPutCrc - Sends the frame CRC, little-endian
+****************************************************************************************/
+static void TelemPutCrc(void) {
+    INT16U crc = CrcResult();
+    BIOWrite((INT8C)crc);
+    BIOWrite((INT8C)(crc >> 8));
+}
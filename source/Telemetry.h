@@ -0,0 +1,76 @@
+/****************************************************************************************
+ * DESCRIPTION: Framed binary telemetry over BasicIO. A capture is sent as frames of up
+ *              to TELEM_FRAME_SAMPLES samples, each x y z interleaved as little-endian
+ *              q15, so the data costs 2 bytes a value instead of 9 as hex text.
+ *              A continuous stream is sent delta and varint coded instead.
+ *              tools/telemetry_decode.py reassembles and checks the frames.
+ *              The frame CRCs come from Crc.c, call CrcInit() first.
+ * AUTHOR: Neal Crawford
+ * HISTORY: Started 10/16/2026
+ ***************************************************************************************
+ * Frame, all fields little-endian:
+ *   0  sync     TELEM_SYNC0, TELEM_SYNC1
+ *   2  type     TELEM_TYPE_x
+ *   3  seq      frame sequence number, wraps at 256
+ *   4  rate     sample rate in Hz, INT16U
+ *   6  axes     values per sample
+ *   7  count    samples in this frame
+ *   8  offset   index of the frame's first sample in the capture, INT16U
+ *  10  total    samples in the capture, INT16U
+ *  12  payload  count * axes INT16S
+ *   n  crc      CRC-16/CCITT-FALSE of bytes 2 to n-1, INT16U
+ * TELEM_TYPE_STREAM frames carry up to TELEM_STREAM_SAMPLES samples of a continuous
+ * stream, and each frame decodes on its own:
+ *   8  offset   index of the frame's first sample in the stream, wraps at 65536
+ *  10  total    payload length in bytes
+ *  12  payload  the first sample as 3 INT16S, then for each further sample and axis
+ *               the difference from the previous sample, zigzag mapped to unsigned
+ *               and sent 7 bits a byte, low first, bit 7 set on all but the last byte
+ ***************************************************************************************/
+#ifndef TELEMETRY_DEF
+#define TELEMETRY_DEF
+
+#define TELEM_SYNC0          0xA5U
+#define TELEM_SYNC1          0x5AU
+#define TELEM_TYPE_CAPTURE   0x01U
+#define TELEM_TYPE_STREAM    0x02U
+#define TELEM_HEADER_BYTES   12U
+#define TELEM_FRAME_SAMPLES  64U    // 384 byte payload for 3 axes, at most 255
+#define TELEM_STREAM_SAMPLES 32U    // 40mS at 800 Hz, at most 255
+
+typedef struct {
+    INT32U rawBytes;    // 6 bytes a sample, the stream as plain INT16S
+    INT32U sentBytes;   // Frames sent, headers and CRCs included
+} TELEM_STREAM_STATS;
+
+/****************************************************************************************
+* TelemetrySendCapture - Sends samples of x, y and z as TELEM_TYPE_CAPTURE frames.
+*                        Blocks until the last byte is written.
+*   rateHz: sample rate put in each header
+****************************************************************************************/
+void TelemetrySendCapture(const INT16S* x, const INT16S* y, const INT16S* z, INT16U samples, INT16U rateHz);
+
+/****************************************************************************************
+* TelemetryStreamStart - Starts a TELEM_TYPE_STREAM stream at sample index 0 and clears
+*                        its statistics
+*   rateHz: sample rate put in each header
+****************************************************************************************/
+void TelemetryStreamStart(INT16U rateHz);
+
+/****************************************************************************************
+* TelemetryStreamSample - Encodes one sample, a frame is sent every TELEM_STREAM_SAMPLES
+****************************************************************************************/
+void TelemetryStreamSample(INT16S x, INT16S y, INT16S z);
+
+/****************************************************************************************
+* TelemetryStreamFlush - Sends the samples encoded since the last frame, if any
+****************************************************************************************/
+void TelemetryStreamFlush(void);
+
+/****************************************************************************************
+* TelemetryStreamStats - Bytes the stream would take as plain samples and bytes sent,
+*                        their ratio is the compression achieved
+****************************************************************************************/
+void TelemetryStreamStats(TELEM_STREAM_STATS* stats);
+
+#endif
@@ -4,18 +4,11 @@
  * HISTORY: Started 05/27/2020
 *****************************************************************************************/
 
-#define SAMPLES_PER_BLOCK 1600 // Two seconds of acceleration data
 #define NUM_DB_TRICKS 3
 
-typedef struct {
-	INT16S samplesX[SAMPLES_PER_BLOCK];
-	INT16S samplesY[SAMPLES_PER_BLOCK];
-	INT16S samplesZ[SAMPLES_PER_BLOCK];
-
-	INT16S absX[SAMPLES_PER_BLOCK];
-	INT16S absY[SAMPLES_PER_BLOCK];
-	INT16S absZ[SAMPLES_PER_BLOCK];
-} ACCEL_BUFFERS;
+/* CRC-16/CCITT-FALSE of TRICK_DB as stored, checked by TrickMatchInit(). Recompute it
+ * after editing the templates with tools/telemetry_decode.py --db-crc source/TrickDB.h */
+#define TRICK_DB_CRC 0xF2C3U
 
 const INT16S TRICK_DB[3][3][SAMPLES_PER_BLOCK] = {
 { // BACK_N_FORTH
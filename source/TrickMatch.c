@@ -0,0 +1,1664 @@
+/****************************************************************************************
+ * DESCRIPTION: Trick classification against the TRICK_DB templates.
+ *              The templates are prepared once at boot: each axis is made zero-mean,
+ *              scaled to full Q15 range and its sums are stored. Classifying a capture
+ *              then costs one pass over the capture for its own statistics, fused into
+ *              the first template's dot product, and a single dot product per template
+ *              axis after that. The inner loops use the Cortex-M4 dual 16-bit MACs.
+ *              Each template is also tried at every offset up to +/-MATCH_MAX_LAG. The
+ *              overlap shrinks by one sample per lag, so the window sums are updated by
+ *              removing that sample and each extra lag costs one dot product per axis.
+ *              A feature cascade can run first: energy, peak position and sign pattern
+ *              per axis, compared with each template's, skip the correlation of
+ *              templates that plainly differ.
+ *              The FFT engine instead keeps each template axis as a Q15 spectrum. A
+ *              capture costs one forward FFT per axis, then per template the weighted
+ *              cross spectra of the three axes are summed and one inverse FFT gives the
+ *              combined correlation at every lag. The peak lag is rescored exactly.
+ *              The DTW engine keeps each template decimated and z-normalized with its
+ *              LB_Keogh envelope. Templates are visited by increasing lower bound and
+ *              the search stops once the bound reaches the best distance so far, so
+ *              usually only one full banded DTW runs per capture.
+ * AUTHOR: Neal Crawford
+ * HISTORY: Started 10/16/2026, TrickIdentify() and SquareRoot() moved from TrickTrackMain.c
+*****************************************************************************************
+* Master header file
+****************************************************************************************/
+#include "MCUType.h"
+#include "FXOS8700CQ.h"
+#include "TrickMatch.h"
+#include "TrickDB.h"
+#include "Crc.h"
+#if TRICK_BENCH_EN
+#include "BasicIO.h"
+#endif
+#if (MATCH_ENGINE == MATCH_ENGINE_FFT) || MATCH_INCREMENTAL_EN
+#include <cr_section_macros.h>
+#endif
+
+#define Q_MAX 32767
+#define NUM_AXES 3
+#define MATCH_THRESHOLD (1 << 28)   // Minimum mean Q31 correlation for a match
+
+#if (MATCH_MAX_LAG < 0) || (MATCH_MAX_LAG >= (SAMPLES_PER_BLOCK / 2))
+#error "MATCH_MAX_LAG must leave at least half of the block overlapping"
+#endif
+#if (MATCH_ENGINE == MATCH_ENGINE_FFT) && (MATCH_MAX_LAG > (MATCH_FFT_LEN - SAMPLES_PER_BLOCK))
+#error "MATCH_MAX_LAG wraps around the FFT, raise MATCH_FFT_LEN"
+#endif
+
+#define COARSE_LEN (SAMPLES_PER_BLOCK / MATCH_COARSE_DECIMATE)
+#define COARSE_MAX_LAG (MATCH_MAX_LAG / MATCH_COARSE_DECIMATE)
+#define COARSE_NUM_TAPS 32
+#define COARSE_BLOCK 200                // arm_fir_decimate_q15 block, a multiple of the factor
+#if (MATCH_COARSE_TOP_K > 0) && ((SAMPLES_PER_BLOCK % COARSE_BLOCK) != 0 || (COARSE_BLOCK % MATCH_COARSE_DECIMATE) != 0)
+#error "COARSE_BLOCK must divide SAMPLES_PER_BLOCK and be a multiple of MATCH_COARSE_DECIMATE"
+#endif
+
+#if MATCH_INCREMENTAL_EN && (MATCH_ENGINE != MATCH_ENGINE_DIRECT)
+#error "MATCH_INCREMENTAL_EN needs the direct engine"
+#endif
+#define INC_LAGS (2 * MATCH_MAX_LAG + 1)    // Lag arrays are indexed by lag + MATCH_MAX_LAG
+/* int64 to float through the top bits, a VCVT instead of a library call. Only used on
+ * values below 2^55, the dropped 2^24 is far below the correlation denominators. */
+#define INC_TO_FP32(v) ((FP32)(INT32S)((v) >> 24) * 16777216.0f)
+/* Samples paired at a lag once length samples of the capture are in */
+#define LAG_OVERLAP(length, lag) ((INT16U)(((lag) >= 0) ? ((length) - (lag)) :                 \
+                                  ((((length) - (lag)) > SAMPLES_PER_BLOCK) ?                     \
+                                   (SAMPLES_PER_BLOCK + (lag)) : (length))))
+#if MATCH_EARLY_EN && !MATCH_INCREMENTAL_EN
+#error "MATCH_EARLY_EN needs MATCH_INCREMENTAL_EN"
+#endif
+#if MATCH_EARLY_EN && (MATCH_EARLY_MIN_SAMPLES <= MATCH_MAX_LAG)
+#error "MATCH_EARLY_MIN_SAMPLES must exceed MATCH_MAX_LAG"
+#endif
+
+#if MATCH_CASCADE_EN && ((MATCH_ENGINE != MATCH_ENGINE_DIRECT) || MATCH_INCREMENTAL_EN)
+#error "MATCH_CASCADE_EN needs the direct engine without MATCH_INCREMENTAL_EN"
+#endif
+/* Cascade feature limits, beyond them an axis feature counts as far off. Tuned with
+ * tools/trickmatch_host on the TRICK_DB recordings shifted up to MATCH_MAX_LAG, at 1/2 to
+ * 1/5 gain and with up to +/-100 counts of noise: a recording scores at most 3 far off
+ * against its own template, 2 under MATCH_CASCADE_PRUNE, and about half of the other
+ * pairs are pruned. At +/-400 counts it still scores at most 4. */
+#define CASCADE_SEGMENTS 8                  // Sign pattern bits per axis
+#define CASCADE_ENERGY_FAR 48               // Energy difference, Q8
+#define CASCADE_PEAK_FAR (MATCH_MAX_LAG + ((3 * SAMPLES_PER_BLOCK) / 16))
+#define CASCADE_SIGNS_FAR 3                 // Differing sign pattern bits
+
+/* The correlation kernels, also built for the benchmark baseline */
+#define MATCH_CORREL_EN ((MATCH_ENGINE != MATCH_ENGINE_DTW) || TRICK_BENCH_EN)
+
+#define DTW_LEN (SAMPLES_PER_BLOCK / MATCH_DTW_DECIMATE)
+#define DTW_ONE 4096                    // One standard deviation after z-normalizing
+#define DTW_INF 0x7FFFFFFFU
+#if (SAMPLES_PER_BLOCK % MATCH_DTW_DECIMATE) != 0
+#error "MATCH_DTW_DECIMATE must divide SAMPLES_PER_BLOCK"
+#endif
+
+/* Template sample as prepared from TRICK_DB, zero-mean and scaled to full Q15 range */
+#define TEMPLATE_SAMPLE(db, mean, maxAbs)   ((INT16S)((((INT32S)(db) - (mean)) * Q_MAX) / (maxAbs)))
+
+/* Dual 16x16 multiply-accumulate on packed Q15 pairs. SMLALD/SMLAD on the M4, a portable
+ * equivalent anywhere else so the kernels can be checked on a host. */
+#if defined(__ARM_FEATURE_DSP) && (__ARM_FEATURE_DSP == 1)
+#define MAC_PAIR64(a, b, acc)   ((INT64S)__SMLALD((a), (b), (INT64U)(acc)))
+#define MAC_PAIR32(a, b, acc)   ((INT32S)__SMLAD((a), (b), (INT32U)(acc)))
+#else
+#define PAIR_LO(p)              ((INT32S)(INT16S)(p))
+#define PAIR_HI(p)              ((INT32S)(INT16S)((p) >> 16))
+#define MAC_PAIR64(a, b, acc)   ((acc) + ((INT64S)PAIR_LO(a) * PAIR_LO(b)) + ((INT64S)PAIR_HI(a) * PAIR_HI(b)))
+#define MAC_PAIR32(a, b, acc)   ((acc) + (PAIR_LO(a) * PAIR_LO(b)) + (PAIR_HI(a) * PAIR_HI(b)))
+#endif
+#define Q15_PAIR_ONES 0x00010001U   // Packed (1, 1), MAC with it sums a pair
+/* Pair load that tolerates the odd sample offsets of the lag search */
+#define Q15_PAIR_READ(p)        ((INT32U)__UNALIGNED_UINT32_READ(p))
+
+#if MATCH_CASCADE_EN
+typedef struct {
+    INT16U energy;          // Mean deviation from the mean over the peak deviation, Q8
+    INT16U peak;            // Index of the peak deviation
+    INT8U signs;            // Bit n set when segment n of CASCADE_SEGMENTS is above the mean
+} AXIS_FEATURES;
+#endif
+
+#if MATCH_ENGINE == MATCH_ENGINE_DIRECT
+typedef struct {
+    INT16S samples[NUM_AXES][SAMPLES_PER_BLOCK];   // Zero-mean, scaled to full Q15 range
+    INT32S sum[NUM_AXES];                          // Near zero, rounding of the mean
+    INT64S sos[NUM_AXES];                          // Sum of squares
+#if (MATCH_COARSE_TOP_K > 0) && !MATCH_INCREMENTAL_EN
+    INT16S coarse[NUM_AXES][COARSE_LEN];           // samples through CoarseDecimate()
+    INT32S coarseSum[NUM_AXES];
+    INT64S coarseSos[NUM_AXES];
+#endif
+#if MATCH_CASCADE_EN
+    AXIS_FEATURES features[NUM_AXES];
+#endif
+} TRICK_TEMPLATE;
+#elif MATCH_ENGINE == MATCH_ENGINE_FFT
+typedef struct {
+    INT16S spectrum[NUM_AXES][MATCH_FFT_LEN];      // arm_rfft_fast_f32 layout, Q15
+    FP32 spectrumScale[NUM_AXES];                  // Q15 to float, includes 1/template norm
+    INT32S mean[NUM_AXES];                         // TEMPLATE_SAMPLE() parameters
+    INT32S maxAbs[NUM_AXES];
+} TRICK_TEMPLATE;
+#else
+typedef struct {
+    INT16S series[NUM_AXES][DTW_LEN];              // Decimated, z-normalized
+    INT16S upper[NUM_AXES][DTW_LEN];               // LB_Keogh envelope over the band
+    INT16S lower[NUM_AXES][DTW_LEN];
+} TRICK_TEMPLATE;
+#endif
+
+typedef struct {
+    INT64S sumXY;
+    INT64S sumXX;
+    INT64S sumYY;
+    INT32S sumX;
+    INT32S sumY;
+} CORREL_SUMS;
+
+/****************************************************************************************
+* Function Prototypes
+****************************************************************************************/
+#if MATCH_ENGINE != MATCH_ENGINE_DTW
+static void TemplateScale(const INT16S* dbSamples, INT32S* mean, INT32S* maxAbs);
+#endif
+#if MATCH_ENGINE == MATCH_ENGINE_DIRECT
+static void TemplatePrepare(const INT16S* dbSamples, INT16S* samples, INT32S* sum, INT64S* sos);
+static void TemplateMatch(INT16S* const capture[], const INT16S* const tmpl[], INT16U length,
+                          INT16U maxLag, const CORREL_SUMS* zeroLag, TRICK_MATCH* best);
+static void LagSweep(INT16S* const capture[], const INT16S* const tmpl[], INT16U length,
+                     INT16U maxLag, const CORREL_SUMS* zeroLag, INT8S direction, TRICK_MATCH* best);
+#if MATCH_INCREMENTAL_EN
+static void LagWindowStats(const INT16S* series, INT16U length, INT8U isCapture, INT32S* lagSum,
+                           FP32* lagInvNorm);
+static INT32S IncrementalMatch(INT8U trick, INT16U length, INT32S (*tmplSum)[INC_LAGS],
+                               FP32 (*tmplInvNorm)[INC_LAGS], TRICK_MATCH* best);
+#elif MATCH_COARSE_TOP_K > 0
+static void CoarseRank(INT16S* const capture[], const INT8U* keep, TRICK_MATCH* coarse);
+static void RefineMatch(INT16S* const capture[], const TRICK_TEMPLATE* tmpl, INT16S coarseLag,
+                        const CORREL_SUMS* full, TRICK_MATCH* best);
+static void CoarseDecimate(const INT16S* samples, INT16S* coarse);
+#endif
+#if MATCH_CASCADE_EN
+static INT8U CascadePrune(INT16S* const capture[], INT16U length, INT8U* keep);
+static void FeatureExtract(const INT16S* series, INT16U length, AXIS_FEATURES* features);
+static INT8U FeaturesFar(const AXIS_FEATURES* a, const AXIS_FEATURES* b);
+#endif
+#elif MATCH_ENGINE == MATCH_ENGINE_FFT
+static void TemplateSpectrum(INT8U trick, INT8U axis);
+static void CaptureSpectra(INT16S* const capture[]);
+static void SpectrumMatch(INT16S* const capture[], INT8U trick, TRICK_MATCH* best);
+static INT32S LagCorrel(INT16S* const capture[], INT8U trick, INT16S lag);
+#else
+static INT32U DtwIdentify(INT16S* const capture[], TRICK_MATCH* match);
+static void SeriesPrepare(const INT16S* samples, INT16S* series);
+static void EnvelopePrepare(const INT16S* series, INT16S* upper, INT16S* lower);
+static INT32U LbKeogh(const TRICK_TEMPLATE* tmpl);
+static INT32U DtwDistance(const TRICK_TEMPLATE* tmpl, INT32U bound);
+#endif
+#if MATCH_CORREL_EN
+static INT32S AxesCorrel(CORREL_SUMS* sums, INT16U length);
+static void CorrelSums(const INT16S* x, const INT16S* y, INT16U length, CORREL_SUMS* sums);
+static INT64S DotProduct(const INT16S* x, const INT16S* y, INT16U length);
+static INT32U NormFromSums(INT64S sum, INT64S sos, INT16U length);
+static INT32S CorrelFromSums(CORREL_SUMS* sums, INT16U length);
+static INT32S CorrelCoeff(INT64S dot, INT32U captureNorm, INT32U templateNorm);
+#endif
+static INT32U SquareRoot(INT64U a_nInput);
+#if TRICK_BENCH_EN
+static INT32S LegacyCorrelCoeff(INT16S* curr_data_buffer, INT16S* db_buffer);
+static INT64U LegacySquareRoot(INT64U a_nInput);
+static void BenchPrint(const INT8C* label, INT32U cycles);
+#endif
+
+/****************************************************************************************
+* Static file variables
+****************************************************************************************/
+static TRICK_TEMPLATE Templates[NUM_DB_TRICKS];
+static INT16U DbCrc;
+#if (MATCH_ENGINE == MATCH_ENGINE_DIRECT) && MATCH_INCREMENTAL_EN
+/* Running dot products of the capture being recorded with every template at every lag,
+ * and the window sums and inverse norms of each lag's overlap. SRAM_LOWER has room next
+ * to the sample buffers. */
+__BSS(RAM2) static INT64S IncDot[NUM_DB_TRICKS][NUM_AXES][INC_LAGS];
+__BSS(RAM2) static INT32S TemplateLagSum[NUM_DB_TRICKS][NUM_AXES][INC_LAGS];
+__BSS(RAM2) static FP32 TemplateLagInvNorm[NUM_DB_TRICKS][NUM_AXES][INC_LAGS];
+static INT32S CaptureLagSum[NUM_AXES][INC_LAGS];
+static FP32 CaptureLagInvNorm[NUM_AXES][INC_LAGS];
+#if MATCH_EARLY_EN
+static INT32S ProgressLagSum[NUM_AXES][INC_LAGS];   // Template stats over the recorded part
+static FP32 ProgressLagInvNorm[NUM_AXES][INC_LAGS];
+#endif
+#elif (MATCH_ENGINE == MATCH_ENGINE_DIRECT) && (MATCH_COARSE_TOP_K > 0)
+/* 32 tap Hamming windowed sinc, cutoff 50 Hz at 800 Hz, unity DC gain */
+static const INT16S CoarseTaps[COARSE_NUM_TAPS] = {
+    -10, -36, -75, -132, -198, -244, -231, -112, 152, 582, 1167, 1861, 2589, 3257, 3768, 4046,
+    4046, 3768, 3257, 2589, 1861, 1167, 582, 152, -112, -231, -244, -198, -132, -75, -36, -10
+};
+static q15_t CoarseState[COARSE_NUM_TAPS + COARSE_BLOCK - 1];
+static INT16S CaptureCoarse[NUM_AXES][COARSE_LEN];
+#endif
+#if MATCH_ENGINE == MATCH_ENGINE_FFT
+static arm_rfft_fast_instance_f32 FftInstance;
+static FP32 FftWork[MATCH_FFT_LEN];                 // FFT input, destroyed by each transform
+static union {
+    FP32 corr[MATCH_FFT_LEN];                       // FFT output
+    INT16S samples[SAMPLES_PER_BLOCK];              // Template axis rebuilt for rescoring
+} FftOut;
+/* The template spectra fill most of SRAM_UPPER, the capture spectra share SRAM_LOWER with
+ * the sample buffers */
+__BSS(RAM2) static FP32 CaptureSpectrum[NUM_AXES][MATCH_FFT_LEN];
+#elif MATCH_ENGINE == MATCH_ENGINE_DTW
+static INT16S CaptureSeries[NUM_AXES][DTW_LEN];
+static INT32U DtwRows[2][DTW_LEN + 1];              // Cost rows, [0] is the band's left edge
+#if TRICK_BENCH_EN
+static INT32U DtwRuns;                              // Full DTWs run and templates pruned
+static INT32U DtwPruned;
+#endif
+#endif
+
+/****************************************************************************************
+* TrickMatchInit - Prepare the TRICK_DB templates once at boot. eDMA feeds TRICK_DB to
+*                  the CRC module while the templates are prepared.
+****************************************************************************************/
+void TrickMatchInit(void) {
+    CrcStart(CRC16_INIT);
+    CrcAddDma((const INT8U*)TRICK_DB, sizeof(TRICK_DB));
+#if MATCH_ENGINE == MATCH_ENGINE_FFT
+    (void)arm_rfft_fast_init_f32(&FftInstance, MATCH_FFT_LEN);
+#endif
+    for (INT8U i = 0; i < NUM_DB_TRICKS; i++) {
+        for (INT8U axis = 0; axis < NUM_AXES; axis++) {
+#if MATCH_ENGINE == MATCH_ENGINE_DIRECT
+            TemplatePrepare(TRICK_DB[i][axis], Templates[i].samples[axis], &Templates[i].sum[axis],
+                            &Templates[i].sos[axis]);
+#if MATCH_CASCADE_EN
+            FeatureExtract(Templates[i].samples[axis], SAMPLES_PER_BLOCK, &Templates[i].features[axis]);
+#endif
+#if MATCH_INCREMENTAL_EN
+            LagWindowStats(Templates[i].samples[axis], SAMPLES_PER_BLOCK, 0, TemplateLagSum[i][axis],
+                           TemplateLagInvNorm[i][axis]);
+#elif MATCH_COARSE_TOP_K > 0
+            CoarseDecimate(Templates[i].samples[axis], Templates[i].coarse[axis]);
+            Templates[i].coarseSum[axis] = 0;
+            Templates[i].coarseSos[axis] = 0;
+            for (INT16U n = 0; n < COARSE_LEN; n++) {
+                Templates[i].coarseSum[axis] += Templates[i].coarse[axis][n];
+                Templates[i].coarseSos[axis] += (INT32S)Templates[i].coarse[axis][n] * Templates[i].coarse[axis][n];
+            }
+#endif
+#elif MATCH_ENGINE == MATCH_ENGINE_FFT
+            TemplateSpectrum(i, axis);
+#else
+            SeriesPrepare(TRICK_DB[i][axis], Templates[i].series[axis]);
+            EnvelopePrepare(Templates[i].series[axis], Templates[i].upper[axis], Templates[i].lower[axis]);
+#endif
+        }
+    }
+    DbCrc = CrcResult();
+}
+
+/****************************************************************************************
+* TrickMatchDbCheck - Checks the CRC of TRICK_DB computed by TrickMatchInit()
+****************************************************************************************/
+INT8U TrickMatchDbCheck(INT16U* crc) {
+    *crc = DbCrc;
+    return (DbCrc == TRICK_DB_CRC) ? 1U : 0U;
+}
+
+/****************************************************************************************
+* TrickIdentify - Identifies the most likely trick match between last recorded movement
+*                 and the trick database. With the direct engine the zero offset pass over
+*                 the first template also gathers the capture statistics every other lag
+*                 and template starts from.
+****************************************************************************************/
+INT32U TrickIdentify(ACCEL_BUFFERS* buffer, TRICK_MATCH* match) {
+    INT16S* capture[NUM_AXES] = {buffer->samplesX, buffer->samplesY, buffer->samplesZ};
+#if MATCH_ENGINE == MATCH_ENGINE_DTW
+    return DtwIdentify(capture, match);
+#else
+    TRICK_MATCH scores[NUM_DB_TRICKS];
+    INT32S corr_means[NUM_DB_TRICKS];
+#if (MATCH_ENGINE == MATCH_ENGINE_DIRECT) && MATCH_INCREMENTAL_EN
+    /* Only the normalization is left, the dot products were accumulated while recording */
+    for (INT8U axis = 0; axis < NUM_AXES; axis++) {
+        LagWindowStats(capture[axis], SAMPLES_PER_BLOCK, 1, CaptureLagSum[axis], CaptureLagInvNorm[axis]);
+    }
+    for (INT8U i = 0; i < NUM_DB_TRICKS; i++) {
+        corr_means[i] = IncrementalMatch(i, SAMPLES_PER_BLOCK, TemplateLagSum[i], TemplateLagInvNorm[i], &scores[i]);
+    }
+#elif (MATCH_ENGINE == MATCH_ENGINE_DIRECT) && (MATCH_COARSE_TOP_K == 0)
+    CORREL_SUMS sums[NUM_AXES];
+    INT8U first = 1;
+    INT8U keep[NUM_DB_TRICKS];
+
+#if MATCH_CASCADE_EN
+    (void)CascadePrune(capture, SAMPLES_PER_BLOCK, keep);
+#else
+    for (INT8U i = 0; i < NUM_DB_TRICKS; i++) {
+        keep[i] = 1;
+    }
+#endif
+    for (INT8U i = 0; i < NUM_DB_TRICKS; i++) {
+        const INT16S* tmpl[NUM_AXES] = {Templates[i].samples[0], Templates[i].samples[1], Templates[i].samples[2]};
+        if (keep[i] == 0) {
+            scores[i].corr = INT32_MIN;
+            scores[i].lag = 0;
+            corr_means[i] = INT32_MIN;
+            continue;
+        } else {}
+        for (INT8U axis = 0; axis < NUM_AXES; axis++) {
+            if (first != 0) {
+                CorrelSums(capture[axis], tmpl[axis], SAMPLES_PER_BLOCK, &sums[axis]);
+            } else {
+                sums[axis].sumXY = DotProduct(capture[axis], tmpl[axis], SAMPLES_PER_BLOCK);
+                sums[axis].sumY = Templates[i].sum[axis];
+                sums[axis].sumYY = Templates[i].sos[axis];
+            }
+        }
+        first = 0;
+        TemplateMatch(capture, tmpl, SAMPLES_PER_BLOCK, MATCH_MAX_LAG, sums, &scores[i]);
+        corr_means[i] = scores[i].corr;
+    }
+#elif MATCH_ENGINE == MATCH_ENGINE_DIRECT
+    /* Rank every template on decimated data, then rescore the best MATCH_COARSE_TOP_K at
+     * full rate. Templates not rescored cannot be picked. */
+    TRICK_MATCH coarse[NUM_DB_TRICKS];
+    CORREL_SUMS full[NUM_AXES];
+    INT8U next;
+    INT8U keep[NUM_DB_TRICKS];
+
+#if MATCH_CASCADE_EN
+    (void)CascadePrune(capture, SAMPLES_PER_BLOCK, keep);
+#else
+    for (INT8U i = 0; i < NUM_DB_TRICKS; i++) {
+        keep[i] = 1;
+    }
+#endif
+    CoarseRank(capture, keep, coarse);
+    for (INT8U i = 0; i < NUM_DB_TRICKS; i++) {
+        corr_means[i] = INT32_MIN;
+        scores[i].corr = INT32_MIN;
+        scores[i].lag = 0;
+    }
+    for (INT8U k = 0; (k < MATCH_COARSE_TOP_K) && (k < NUM_DB_TRICKS); k++) {
+        next = 0;
+        for (INT8U i = 1; i < NUM_DB_TRICKS; i++) {
+            if (coarse[i].corr > coarse[next].corr) {
+                next = i;
+            } else {}
+        }
+        if (keep[next] == 0) {
+            break;          // Pruned or already refined, nothing left
+        } else {}
+        if (k == 0) {       // Capture totals for every refined template
+            for (INT8U axis = 0; axis < NUM_AXES; axis++) {
+                CorrelSums(capture[axis], Templates[next].samples[axis], SAMPLES_PER_BLOCK, &full[axis]);
+            }
+        } else {}
+        RefineMatch(capture, &Templates[next], coarse[next].lag, full, &scores[next]);
+        corr_means[next] = scores[next].corr;
+        coarse[next].corr = INT32_MIN;
+        keep[next] = 0;
+    }
+#elif MATCH_ENGINE == MATCH_ENGINE_FFT
+    CaptureSpectra(capture);
+    for (INT8U i = 0; i < NUM_DB_TRICKS; i++) {
+        SpectrumMatch(capture, i, &scores[i]);
+        corr_means[i] = scores[i].corr;
+    }
+#endif
+
+    q31_t max_val;
+    INT32U max_index;
+    arm_max_q31(corr_means, NUM_DB_TRICKS, &max_val, &max_index);
+    *match = scores[max_index];
+    match->distance = 0;
+    match->samples = SAMPLES_PER_BLOCK;
+    if (max_val > MATCH_THRESHOLD) {
+        return max_index + 1;
+    } else {
+        return 0;
+    }
+#endif
+}
+
+#if MATCH_EARLY_EN
+/****************************************************************************************
+* TrickIdentifyEarly - Scores the recorded part of a capture against the same part of each
+*                      template, so a trick can be reported before its window fills. The
+*                      capture is raw as for TrickIdentify() in incremental mode.
+****************************************************************************************/
+INT32U TrickIdentifyEarly(ACCEL_BUFFERS* buffer, INT16U count, TRICK_MATCH* match) {
+    INT16S* capture[NUM_AXES] = {buffer->samplesX, buffer->samplesY, buffer->samplesZ};
+    TRICK_MATCH score;
+    INT32S best = INT32_MIN;
+    INT32S second = INT32_MIN;
+    INT32U bestTrick = 0;
+
+    if ((count < MATCH_EARLY_MIN_SAMPLES) || (count >= SAMPLES_PER_BLOCK) ||
+        ((count % MATCH_EARLY_STEP) != 0)) {
+        return 0;
+    } else {}
+    for (INT8U axis = 0; axis < NUM_AXES; axis++) {
+        LagWindowStats(capture[axis], count, 1, CaptureLagSum[axis], CaptureLagInvNorm[axis]);
+    }
+    for (INT8U i = 0; i < NUM_DB_TRICKS; i++) {
+        for (INT8U axis = 0; axis < NUM_AXES; axis++) {
+            LagWindowStats(Templates[i].samples[axis], count, 0, ProgressLagSum[axis], ProgressLagInvNorm[axis]);
+        }
+        (void)IncrementalMatch(i, count, ProgressLagSum, ProgressLagInvNorm, &score);
+        if (score.corr > best) {
+            second = best;
+            best = score.corr;
+            bestTrick = i + 1U;
+            *match = score;
+        } else if (score.corr > second) {
+            second = score.corr;
+        } else {}
+    }
+    if ((best > MATCH_THRESHOLD) && (((INT64S)best - second) >= MATCH_EARLY_MARGIN)) {
+        match->distance = 0;
+        match->samples = count;
+        return bestTrick;
+    } else {
+        return 0;
+    }
+}
+#endif
+
+#if MATCH_ENGINE == MATCH_ENGINE_DIRECT
+/****************************************************************************************
+* TemplateMatch - Best mean correlation of one template over offsets up to +/-maxLag,
+*                 starting from the zero offset sums. Ties keep the smaller offset.
+****************************************************************************************/
+static void TemplateMatch(INT16S* const capture[], const INT16S* const tmpl[], INT16U length,
+                          INT16U maxLag, const CORREL_SUMS* zeroLag, TRICK_MATCH* best) {
+    CORREL_SUMS sums[NUM_AXES];
+
+    for (INT8U axis = 0; axis < NUM_AXES; axis++) {
+        sums[axis] = zeroLag[axis];
+    }
+    best->corr = AxesCorrel(sums, length);
+    best->lag = 0;
+    LagSweep(capture, tmpl, length, maxLag, zeroLag, 1, best);
+    LagSweep(capture, tmpl, length, maxLag, zeroLag, -1, best);
+}
+
+/****************************************************************************************
+* LagSweep - Walks the offsets 1..maxLag in one direction. A positive direction pairs
+*            capture[n + lag] with template[n], so each step drops the first capture
+*            sample and the last template sample still in the overlap. A negative one
+*            drops the last capture and the first template sample.
+****************************************************************************************/
+static void LagSweep(INT16S* const capture[], const INT16S* const tmpl[], INT16U length,
+                     INT16U maxLag, const CORREL_SUMS* zeroLag, INT8S direction, TRICK_MATCH* best) {
+    CORREL_SUMS sums[NUM_AXES];
+    const INT16S* x;
+    const INT16S* y;
+    INT32S xOut, yOut;
+    INT16U overlap;
+    INT32S corr;
+
+    for (INT8U axis = 0; axis < NUM_AXES; axis++) {
+        sums[axis] = zeroLag[axis];
+    }
+    for (INT16U lag = 1; lag <= maxLag; lag++) {
+        overlap = length - lag;
+        for (INT8U axis = 0; axis < NUM_AXES; axis++) {
+            x = capture[axis];
+            y = tmpl[axis];
+            if (direction > 0) {
+                xOut = x[lag - 1U];
+                yOut = y[overlap];
+                x += lag;
+            } else {
+                xOut = x[overlap];
+                yOut = y[lag - 1U];
+                y += lag;
+            }
+            sums[axis].sumX -= xOut;
+            sums[axis].sumXX -= xOut * xOut;
+            sums[axis].sumY -= yOut;
+            sums[axis].sumYY -= yOut * yOut;
+            sums[axis].sumXY = DotProduct(x, y, overlap);
+        }
+        corr = AxesCorrel(sums, overlap);
+        if (corr > best->corr) {
+            best->corr = corr;
+            best->lag = (INT16S)(direction * (INT16S)lag);
+        } else {}
+    }
+}
+
+#if MATCH_INCREMENTAL_EN
+/****************************************************************************************
+* TrickMatchAccumulate - Adds capture[index] x template[index - lag] to every template's
+*                        dot product at each lag whose overlap holds index
+****************************************************************************************/
+void TrickMatchAccumulate(const ACCEL_DATA_3D* sample, INT16U index) {
+    INT32S x[NUM_AXES] = {sample->x, sample->y, sample->z};
+    INT16S first = (INT16S)index - (SAMPLES_PER_BLOCK - 1);
+    INT16S last = (INT16S)index;
+    const INT16S* y;
+    INT64S* dot;
+
+    if (index == 0) {
+        for (INT8U i = 0; i < NUM_DB_TRICKS; i++) {
+            for (INT8U axis = 0; axis < NUM_AXES; axis++) {
+                for (INT16U k = 0; k < INC_LAGS; k++) {
+                    IncDot[i][axis][k] = 0;
+                }
+            }
+        }
+    } else {}
+    if (first < -MATCH_MAX_LAG) {
+        first = -MATCH_MAX_LAG;
+    } else {}
+    if (last > MATCH_MAX_LAG) {
+        last = MATCH_MAX_LAG;
+    } else {}
+    for (INT8U i = 0; i < NUM_DB_TRICKS; i++) {
+        for (INT8U axis = 0; axis < NUM_AXES; axis++) {
+            y = &Templates[i].samples[axis][index];
+            dot = &IncDot[i][axis][MATCH_MAX_LAG];
+            for (INT16S lag = first; lag <= last; lag++) {
+                dot[lag] += x[axis] * y[-lag];
+            }
+        }
+    }
+}
+
+/****************************************************************************************
+* LagWindowStats - Sum and 1/sqrt(n*sos - sum^2) of a series' overlap at every lag when
+*                  only its first length samples have been recorded. A capture loses its
+*                  head at positive lags and anything past the template's end at negative
+*                  ones. A template loses its tail at positive lags and its window slides
+*                  right at negative ones. Done in integers so the raw capture's gravity
+*                  offset does not cancel away the variance.
+****************************************************************************************/
+static void LagWindowStats(const INT16S* series, INT16U length, INT8U isCapture, INT32S* lagSum,
+                           FP32* lagInvNorm) {
+    INT32S sum = 0;
+    INT64S sos = 0;
+    INT32S s;
+    INT64S q;
+    INT32S out;
+    INT32S in;
+    INT16S lag;
+    INT64S spread;
+    FP32 root;
+
+    for (INT16U i = 0; i < length; i++) {
+        sum += series[i];
+        sos += (INT32S)series[i] * series[i];
+    }
+    for (INT8S direction = 1; direction >= -1; direction -= 2) {
+        s = sum;
+        q = sos;
+        for (INT16U m = 0; m <= MATCH_MAX_LAG; m++) {
+            if (m == 0) {
+                /* Full series */
+            } else if (direction > 0) {
+                out = isCapture ? series[m - 1U] : series[length - m];
+                s -= out;
+                q -= out * out;
+            } else if (isCapture) {
+                if ((length + m) > SAMPLES_PER_BLOCK) {
+                    out = series[SAMPLES_PER_BLOCK - m];
+                    s -= out;
+                    q -= out * out;
+                } else {}
+            } else {
+                out = series[m - 1U];
+                in = ((length + m) <= SAMPLES_PER_BLOCK) ? series[length + m - 1U] : 0;
+                s += in - out;
+                q += (in * in) - (out * out);
+            }
+            lag = direction * (INT16S)m;
+            spread = ((INT64S)LAG_OVERLAP(length, lag) * q) - ((INT64S)s * s);
+            if (spread > 0) {
+                (void)arm_sqrt_f32((FP32)spread, &root);
+                root = 1.0f / root;
+            } else {
+                root = 0.0f;
+            }
+            lagSum[MATCH_MAX_LAG + lag] = s;
+            lagInvNorm[MATCH_MAX_LAG + lag] = root;
+        }
+    }
+}
+
+/****************************************************************************************
+* IncrementalMatch - Best mean correlation of one template over the accumulated lags after
+*                    length samples, r = (n*dot - sumX*sumY) / sqrt((n*sosX - sumX^2)
+*                    (n*sosY - sumY^2)). Lags are visited outward from 0 so ties keep the
+*                    smaller offset.
+*   return: the best mean correlation in Q31
+****************************************************************************************/
+static INT32S IncrementalMatch(INT8U trick, INT16U length, INT32S (*tmplSum)[INC_LAGS],
+                               FP32 (*tmplInvNorm)[INC_LAGS], TRICK_MATCH* best) {
+    FP32 bestCorr = -2.0f;
+    FP32 corr;
+    INT16S lag;
+    INT16U k;
+    INT16U n;
+
+    best->lag = 0;
+    for (INT16U step = 0; step < INC_LAGS; step++) {
+        lag = (INT16S)((step + 1U) / 2U);
+        lag = ((step & 1U) != 0) ? lag : (INT16S)-lag;
+        k = (INT16U)(MATCH_MAX_LAG + lag);
+        n = LAG_OVERLAP(length, lag);
+        corr = 0.0f;
+        for (INT8U axis = 0; axis < NUM_AXES; axis++) {
+            corr += INC_TO_FP32(((INT64S)n * IncDot[trick][axis][k]) -
+                                ((INT64S)CaptureLagSum[axis][k] * tmplSum[axis][k])) *
+                    CaptureLagInvNorm[axis][k] * tmplInvNorm[axis][k];
+        }
+        if (corr > bestCorr) {
+            bestCorr = corr;
+            best->lag = lag;
+        } else {}
+    }
+    bestCorr /= NUM_AXES;
+    if (bestCorr >= 1.0f) {         // 2147483647.0f rounds to 2^31, past INT32_MAX
+        best->corr = INT32_MAX;
+    } else if (bestCorr <= -1.0f) {
+        best->corr = -INT32_MAX;
+    } else {
+        best->corr = (INT32S)(bestCorr * 2147483648.0f);
+    }
+    return best->corr;
+}
+
+#elif MATCH_COARSE_TOP_K > 0
+/****************************************************************************************
+* CoarseRank - Lag searches every kept template on the decimated data, where each lag
+*              costs 1/MATCH_COARSE_DECIMATE of a full rate one and there are as many
+*              fewer lags to try. The others are ranked last.
+****************************************************************************************/
+static void CoarseRank(INT16S* const capture[], const INT8U* keep, TRICK_MATCH* coarse) {
+    INT16S* captureCoarse[NUM_AXES] = {CaptureCoarse[0], CaptureCoarse[1], CaptureCoarse[2]};
+    CORREL_SUMS sums[NUM_AXES];
+    INT8U first = 1;
+
+    for (INT8U axis = 0; axis < NUM_AXES; axis++) {
+        CoarseDecimate(capture[axis], CaptureCoarse[axis]);
+    }
+    for (INT8U i = 0; i < NUM_DB_TRICKS; i++) {
+        const INT16S* tmpl[NUM_AXES] = {Templates[i].coarse[0], Templates[i].coarse[1], Templates[i].coarse[2]};
+        if (keep[i] == 0) {
+            coarse[i].corr = INT32_MIN;
+            coarse[i].lag = 0;
+            continue;
+        } else {}
+        for (INT8U axis = 0; axis < NUM_AXES; axis++) {
+            if (first != 0) {
+                CorrelSums(CaptureCoarse[axis], tmpl[axis], COARSE_LEN, &sums[axis]);
+            } else {
+                sums[axis].sumXY = DotProduct(CaptureCoarse[axis], tmpl[axis], COARSE_LEN);
+                sums[axis].sumY = Templates[i].coarseSum[axis];
+                sums[axis].sumYY = Templates[i].coarseSos[axis];
+            }
+        }
+        first = 0;
+        TemplateMatch(captureCoarse, tmpl, COARSE_LEN, COARSE_MAX_LAG, sums, &coarse[i]);
+    }
+}
+
+/****************************************************************************************
+* RefineMatch - Full rate correlation of one template over the offsets within one
+*               decimation step of the coarse offset. full holds the capture sums over
+*               the whole block. Each offset's window sums come from the totals less the
+*               samples outside the overlap.
+****************************************************************************************/
+static void RefineMatch(INT16S* const capture[], const TRICK_TEMPLATE* tmpl, INT16S coarseLag,
+                        const CORREL_SUMS* full, TRICK_MATCH* best) {
+    CORREL_SUMS sums[NUM_AXES];
+    INT16S first = (INT16S)((coarseLag * MATCH_COARSE_DECIMATE) - MATCH_COARSE_DECIMATE);
+    INT16S last = (INT16S)((coarseLag * MATCH_COARSE_DECIMATE) + MATCH_COARSE_DECIMATE);
+    const INT16S* x;
+    const INT16S* y;
+    const INT16S* xDrop;
+    const INT16S* yDrop;
+    INT16U shift;
+    INT16U length;
+    INT32S corr;
+
+    if (first < -MATCH_MAX_LAG) {
+        first = -MATCH_MAX_LAG;
+    } else {}
+    if (last > MATCH_MAX_LAG) {
+        last = MATCH_MAX_LAG;
+    } else {}
+    best->corr = -INT32_MAX;
+    best->lag = 0;
+    for (INT16S lag = first; lag <= last; lag++) {
+        shift = (INT16U)((lag < 0) ? -lag : lag);
+        length = SAMPLES_PER_BLOCK - shift;
+        for (INT8U axis = 0; axis < NUM_AXES; axis++) {
+            x = capture[axis];
+            y = tmpl->samples[axis];
+            if (lag >= 0) {
+                xDrop = x;
+                yDrop = &y[length];
+                x += shift;
+            } else {
+                xDrop = &x[length];
+                yDrop = y;
+                y += shift;
+            }
+            sums[axis].sumX = full[axis].sumX;
+            sums[axis].sumXX = full[axis].sumXX;
+            sums[axis].sumY = tmpl->sum[axis];
+            sums[axis].sumYY = tmpl->sos[axis];
+            for (INT16U i = 0; i < shift; i++) {
+                sums[axis].sumX -= xDrop[i];
+                sums[axis].sumXX -= (INT32S)xDrop[i] * xDrop[i];
+                sums[axis].sumY -= yDrop[i];
+                sums[axis].sumYY -= (INT32S)yDrop[i] * yDrop[i];
+            }
+            sums[axis].sumXY = DotProduct(x, y, length);
+        }
+        corr = AxesCorrel(sums, length);
+        if ((corr > best->corr) || ((corr == best->corr) && (shift < ((best->lag < 0) ? -best->lag : best->lag)))) {
+            best->corr = corr;
+            best->lag = lag;
+        } else {}
+    }
+}
+
+/****************************************************************************************
+* CoarseDecimate - Low pass filters and decimates one axis by MATCH_COARSE_DECIMATE with
+*                  arm_fir_decimate_q15, a block at a time from a cleared state
+****************************************************************************************/
+static void CoarseDecimate(const INT16S* samples, INT16S* coarse) {
+    arm_fir_decimate_instance_q15 decimator;
+
+    (void)arm_fir_decimate_init_q15(&decimator, COARSE_NUM_TAPS, MATCH_COARSE_DECIMATE,
+                                    (q15_t*)CoarseTaps, CoarseState, COARSE_BLOCK);
+    for (INT16U i = 0; i < SAMPLES_PER_BLOCK; i += COARSE_BLOCK) {
+        arm_fir_decimate_q15(&decimator, (q15_t*)&samples[i], &coarse[i / MATCH_COARSE_DECIMATE], COARSE_BLOCK);
+    }
+}
+#endif
+#elif MATCH_ENGINE == MATCH_ENGINE_FFT
+
+/****************************************************************************************
+* TemplateSpectrum - Builds the Q15 spectrum of one prepared template axis. Its scale
+*                    also divides by the template norm, so the axes are weighted alike
+*                    when their cross spectra are summed.
+****************************************************************************************/
+static void TemplateSpectrum(INT8U trick, INT8U axis) {
+    TRICK_TEMPLATE* tmpl = &Templates[trick];
+    const INT16S* dbSamples = TRICK_DB[trick][axis];
+    FP32 sos = 0.0f;
+    FP32 peak = 0.0f;
+    FP32 norm;
+    FP32 mag;
+
+    TemplateScale(dbSamples, &tmpl->mean[axis], &tmpl->maxAbs[axis]);
+    for (INT16U i = 0; i < MATCH_FFT_LEN; i++) {
+        if (i < SAMPLES_PER_BLOCK) {
+            FftWork[i] = (FP32)TEMPLATE_SAMPLE(dbSamples[i], tmpl->mean[axis], tmpl->maxAbs[axis]);
+            sos += FftWork[i] * FftWork[i];
+        } else {
+            FftWork[i] = 0.0f;      // Zero padding keeps the lags from wrapping
+        }
+    }
+    arm_rfft_fast_f32(&FftInstance, FftWork, FftOut.corr, 0);
+    for (INT16U i = 0; i < MATCH_FFT_LEN; i++) {
+        mag = (FftOut.corr[i] < 0.0f) ? -FftOut.corr[i] : FftOut.corr[i];
+        if (mag > peak) {
+            peak = mag;
+        } else {}
+    }
+    if ((peak == 0.0f) || (sos == 0.0f)) {
+        peak = 1.0f;
+        sos = 1.0f;
+    } else {}
+    for (INT16U i = 0; i < MATCH_FFT_LEN; i++) {
+        tmpl->spectrum[axis][i] = (INT16S)((FftOut.corr[i] * Q_MAX) / peak);
+    }
+    (void)arm_sqrt_f32(sos, &norm);
+    tmpl->spectrumScale[axis] = peak / (Q_MAX * norm);
+}
+
+/****************************************************************************************
+* CaptureSpectra - Forward FFT of each capture axis after removing its mean and dividing
+*                  by its norm
+****************************************************************************************/
+static void CaptureSpectra(INT16S* const capture[]) {
+    INT32S sum;
+    INT64S sos;
+    FP32 mean;
+    FP32 scale;
+    FP32 norm;
+
+    for (INT8U axis = 0; axis < NUM_AXES; axis++) {
+        sum = 0;
+        sos = 0;
+        for (INT16U i = 0; i < SAMPLES_PER_BLOCK; i++) {
+            sum += capture[axis][i];
+            sos += (INT32S)capture[axis][i] * capture[axis][i];
+        }
+        mean = (FP32)sum / SAMPLES_PER_BLOCK;
+        (void)arm_sqrt_f32((FP32)sos - (mean * (FP32)sum), &norm);
+        scale = (norm > 0.0f) ? (1.0f / norm) : 0.0f;
+        for (INT16U i = 0; i < MATCH_FFT_LEN; i++) {
+            if (i < SAMPLES_PER_BLOCK) {
+                FftWork[i] = ((FP32)capture[axis][i] - mean) * scale;
+            } else {
+                FftWork[i] = 0.0f;
+            }
+        }
+        arm_rfft_fast_f32(&FftInstance, FftWork, CaptureSpectrum[axis], 0);
+    }
+}
+
+/****************************************************************************************
+* SpectrumMatch - Sums capture x conj(template) over the axes, one inverse FFT turns it
+*                 into the combined correlation at every lag. The peak within
+*                 +/-MATCH_MAX_LAG is rescored exactly, ties keep the smaller offset.
+*                 FFT output index lag holds capture[n + lag] x template[n], the negative
+*                 lags sit at the end of the buffer.
+****************************************************************************************/
+static void SpectrumMatch(INT16S* const capture[], INT8U trick, TRICK_MATCH* best) {
+    const TRICK_TEMPLATE* tmpl = &Templates[trick];
+    const FP32* x;
+    const INT16S* t;
+    FP32 scale;
+    FP32 tRe, tIm;
+    FP32 peak;
+    INT16S bestLag = 0;
+
+    for (INT16U i = 0; i < MATCH_FFT_LEN; i++) {
+        FftWork[i] = 0.0f;
+    }
+    for (INT8U axis = 0; axis < NUM_AXES; axis++) {
+        x = CaptureSpectrum[axis];
+        t = tmpl->spectrum[axis];
+        scale = tmpl->spectrumScale[axis];
+        FftWork[0] += x[0] * (t[0] * scale);     // DC and Nyquist are real and packed first
+        FftWork[1] += x[1] * (t[1] * scale);
+        for (INT16U k = 2; k < MATCH_FFT_LEN; k += 2) {
+            tRe = t[k] * scale;
+            tIm = t[k + 1U] * scale;
+            FftWork[k] += (x[k] * tRe) + (x[k + 1U] * tIm);
+            FftWork[k + 1U] += (x[k + 1U] * tRe) - (x[k] * tIm);
+        }
+    }
+    arm_rfft_fast_f32(&FftInstance, FftWork, FftOut.corr, 1);
+
+    peak = FftOut.corr[0];
+    for (INT16U lag = 1; lag <= MATCH_MAX_LAG; lag++) {
+        if (FftOut.corr[lag] > peak) {
+            peak = FftOut.corr[lag];
+            bestLag = (INT16S)lag;
+        } else {}
+        if (FftOut.corr[MATCH_FFT_LEN - lag] > peak) {
+            peak = FftOut.corr[MATCH_FFT_LEN - lag];
+            bestLag = -(INT16S)lag;
+        } else {}
+    }
+    best->lag = bestLag;
+    best->corr = LagCorrel(capture, trick, bestLag);
+}
+
+/****************************************************************************************
+* LagCorrel - Exact mean Pearson correlation at one offset. The template axes are rebuilt
+*             from TRICK_DB, they are not kept in RAM with this engine.
+****************************************************************************************/
+static INT32S LagCorrel(INT16S* const capture[], INT8U trick, INT16S lag) {
+    const TRICK_TEMPLATE* tmpl = &Templates[trick];
+    CORREL_SUMS sums[NUM_AXES];
+    INT16U shift = (INT16U)((lag < 0) ? -lag : lag);
+    INT16U length = SAMPLES_PER_BLOCK - shift;
+    const INT16S* dbSamples;
+
+    for (INT8U axis = 0; axis < NUM_AXES; axis++) {
+        dbSamples = TRICK_DB[trick][axis];
+        for (INT16U i = 0; i < SAMPLES_PER_BLOCK; i++) {
+            FftOut.samples[i] = TEMPLATE_SAMPLE(dbSamples[i], tmpl->mean[axis], tmpl->maxAbs[axis]);
+        }
+        if (lag >= 0) {
+            CorrelSums(&capture[axis][shift], FftOut.samples, length, &sums[axis]);
+        } else {
+            CorrelSums(capture[axis], &FftOut.samples[shift], length, &sums[axis]);
+        }
+    }
+    return AxesCorrel(sums, length);
+}
+#else
+
+/****************************************************************************************
+* DtwIdentify - Lower bounds every template, then runs the banded DTW in order of
+*               increasing bound. A template whose bound is not below the best distance
+*               so far, or the match threshold, cannot win and is skipped.
+****************************************************************************************/
+static INT32U DtwIdentify(INT16S* const capture[], TRICK_MATCH* match) {
+    INT32U bounds[NUM_DB_TRICKS];
+    INT8U visited[NUM_DB_TRICKS] = {0};
+    INT32U best = (INT32U)MATCH_DTW_THRESHOLD * DTW_LEN;
+    INT32U bestTrick = 0;
+    INT32U dist;
+    INT8U next;
+
+    for (INT8U axis = 0; axis < NUM_AXES; axis++) {
+        SeriesPrepare(capture[axis], CaptureSeries[axis]);
+    }
+    for (INT8U i = 0; i < NUM_DB_TRICKS; i++) {
+        bounds[i] = LbKeogh(&Templates[i]);
+    }
+    for (INT8U n = 0; n < NUM_DB_TRICKS; n++) {
+        next = NUM_DB_TRICKS;
+        for (INT8U i = 0; i < NUM_DB_TRICKS; i++) {
+            if ((visited[i] == 0) && ((next == NUM_DB_TRICKS) || (bounds[i] < bounds[next]))) {
+                next = i;
+            } else {}
+        }
+        visited[next] = 1;
+        if (bounds[next] >= best) {     // Sorted, so every remaining bound is as large
+#if TRICK_BENCH_EN
+            DtwPruned += NUM_DB_TRICKS - n;
+#endif
+            break;
+        } else {}
+        dist = DtwDistance(&Templates[next], best);
+#if TRICK_BENCH_EN
+        DtwRuns++;
+#endif
+        if (dist < best) {
+            best = dist;
+            bestTrick = next + 1U;
+        } else {}
+    }
+    match->corr = 0;
+    match->lag = 0;
+    match->distance = (bestTrick != 0) ? (best / DTW_LEN) : DTW_INF;
+    match->samples = SAMPLES_PER_BLOCK;
+    return bestTrick;
+}
+
+/****************************************************************************************
+* SeriesPrepare - Averages each MATCH_DTW_DECIMATE samples and z-normalizes the result
+*                 to DTW_ONE per standard deviation, so the rider's and the template's
+*                 amplitudes do not matter
+****************************************************************************************/
+static void SeriesPrepare(const INT16S* samples, INT16S* series) {
+    INT32S block;
+    INT32S sum = 0;
+    INT64S sos = 0;
+    INT32S mean;
+    INT32U dev;
+    INT32S z;
+
+    for (INT16U i = 0; i < DTW_LEN; i++) {
+        block = 0;
+        for (INT8U k = 0; k < MATCH_DTW_DECIMATE; k++) {
+            block += *samples++;
+        }
+        series[i] = (INT16S)(block / MATCH_DTW_DECIMATE);
+        sum += series[i];
+        sos += (INT32S)series[i] * series[i];
+    }
+    mean = sum / DTW_LEN;
+    dev = SquareRoot((INT64U)((sos - (((INT64S)sum * sum) / DTW_LEN)) / DTW_LEN));
+    if (dev == 0) {
+        dev = 1;
+    } else {}
+    for (INT16U i = 0; i < DTW_LEN; i++) {
+        z = (((INT32S)series[i] - mean) * DTW_ONE) / (INT32S)dev;
+        if (z > Q_MAX) {
+            z = Q_MAX;
+        } else if (z < -Q_MAX) {
+            z = -Q_MAX;
+        } else {}
+        series[i] = (INT16S)z;
+    }
+}
+
+/****************************************************************************************
+* EnvelopePrepare - Running max and min of a template series over +/-MATCH_DTW_BAND
+****************************************************************************************/
+static void EnvelopePrepare(const INT16S* series, INT16S* upper, INT16S* lower) {
+    INT16U lo, hi;
+
+    for (INT16U i = 0; i < DTW_LEN; i++) {
+        lo = (i > MATCH_DTW_BAND) ? (i - MATCH_DTW_BAND) : 0;
+        hi = ((i + MATCH_DTW_BAND) < DTW_LEN) ? (i + MATCH_DTW_BAND) : (DTW_LEN - 1);
+        upper[i] = series[lo];
+        lower[i] = series[lo];
+        for (INT16U j = lo + 1U; j <= hi; j++) {
+            if (series[j] > upper[i]) {
+                upper[i] = series[j];
+            } else if (series[j] < lower[i]) {
+                lower[i] = series[j];
+            } else {}
+        }
+    }
+}
+
+/****************************************************************************************
+* LbKeogh - Sum of how far the capture leaves the template envelope. Any warping path
+*           inside the band pays at least this much.
+****************************************************************************************/
+static INT32U LbKeogh(const TRICK_TEMPLATE* tmpl) {
+    INT32U bound = 0;
+    INT16S c;
+
+    for (INT8U axis = 0; axis < NUM_AXES; axis++) {
+        for (INT16U i = 0; i < DTW_LEN; i++) {
+            c = CaptureSeries[axis][i];
+            if (c > tmpl->upper[axis][i]) {
+                bound += (INT32U)(c - tmpl->upper[axis][i]);
+            } else if (c < tmpl->lower[axis][i]) {
+                bound += (INT32U)(tmpl->lower[axis][i] - c);
+            } else {}
+        }
+    }
+    return bound;
+}
+
+/****************************************************************************************
+* DtwDistance - Banded DTW between the capture and a template series, L1 cost summed
+*               over the axes. Two cost rows hold only the band plus a guard cell on
+*               each side. Gives up with DTW_INF once a whole row reaches bound.
+****************************************************************************************/
+static INT32U DtwDistance(const TRICK_TEMPLATE* tmpl, INT32U bound) {
+    INT32U* prev = DtwRows[0];
+    INT32U* curr = DtwRows[1];
+    INT32U* swap;
+    INT32U rowMin;
+    INT32U step;
+    INT32U cost;
+    INT32S diff;
+    INT16U lo, hi;
+
+    for (INT16U j = 0; j <= DTW_LEN; j++) {
+        prev[j] = DTW_INF;
+        curr[j] = DTW_INF;
+    }
+    for (INT16U i = 0; i < DTW_LEN; i++) {
+        lo = (i > MATCH_DTW_BAND) ? (i - MATCH_DTW_BAND) : 0;
+        hi = ((i + MATCH_DTW_BAND) < DTW_LEN) ? (i + MATCH_DTW_BAND) : (DTW_LEN - 1);
+        rowMin = DTW_INF;
+        /* Cell j lives at [j + 1], so [lo] is the guard on the left */
+        curr[lo] = DTW_INF;
+        for (INT16U j = lo; j <= hi; j++) {
+            cost = 0;
+            for (INT8U axis = 0; axis < NUM_AXES; axis++) {
+                diff = (INT32S)CaptureSeries[axis][i] - tmpl->series[axis][j];
+                cost += (INT32U)((diff < 0) ? -diff : diff);
+            }
+            if ((i == 0) && (j == 0)) {
+                step = 0;
+            } else {
+                step = prev[j + 1U];            // (i - 1, j)
+                if (prev[j] < step) {           // (i - 1, j - 1)
+                    step = prev[j];
+                } else {}
+                if (curr[j] < step) {           // (i, j - 1)
+                    step = curr[j];
+                } else {}
+            }
+            curr[j + 1U] = (step == DTW_INF) ? DTW_INF : (step + cost);
+            if (curr[j + 1U] < rowMin) {
+                rowMin = curr[j + 1U];
+            } else {}
+        }
+        if (hi < (DTW_LEN - 1)) {
+            curr[hi + 2U] = DTW_INF;    // Guard on the right for the next row
+        } else {}
+        if (rowMin >= bound) {
+            return DTW_INF;
+        } else {}
+        swap = prev;
+        prev = curr;
+        curr = swap;
+    }
+    return prev[DTW_LEN];
+}
+#endif
+
+#if MATCH_ENGINE != MATCH_ENGINE_DTW
+/****************************************************************************************
+* TemplateScale - Mean and largest deviation from it of one TRICK_DB axis, the
+*                 TEMPLATE_SAMPLE() parameters
+****************************************************************************************/
+static void TemplateScale(const INT16S* dbSamples, INT32S* mean, INT32S* maxAbs) {
+    INT32S dbSum = 0;
+    INT32S adj;
+
+    for (INT16U i = 0; i < SAMPLES_PER_BLOCK; i++) {
+        dbSum += dbSamples[i];
+    }
+    *mean = dbSum / SAMPLES_PER_BLOCK;
+    *maxAbs = 1;
+    for (INT16U i = 0; i < SAMPLES_PER_BLOCK; i++) {
+        adj = (INT32S)dbSamples[i] - *mean;
+        if (adj < 0) {
+            adj = -adj;
+        } else {}
+        if (adj > *maxAbs) {
+            *maxAbs = adj;
+        } else {}
+    }
+}
+#endif
+
+#if MATCH_ENGINE == MATCH_ENGINE_DIRECT
+/****************************************************************************************
+* TemplatePrepare - Removes the mean of one TRICK_DB axis, scales it to full Q15 range
+*                   and computes its sum and sum of squares
+****************************************************************************************/
+static void TemplatePrepare(const INT16S* dbSamples, INT16S* samples, INT32S* sum, INT64S* sos) {
+    INT32S mean;
+    INT32S maxAbs;
+
+    TemplateScale(dbSamples, &mean, &maxAbs);
+    *sum = 0;
+    *sos = 0;
+    for (INT16U i = 0; i < SAMPLES_PER_BLOCK; i++) {
+        samples[i] = TEMPLATE_SAMPLE(dbSamples[i], mean, maxAbs);
+        *sum += samples[i];
+        *sos += (INT32S)samples[i] * samples[i];
+    }
+}
+
+#if MATCH_CASCADE_EN
+/****************************************************************************************
+* CascadePrune - Marks which templates are worth correlating, from the features of the
+*                first length samples of the capture
+*   keep: 1 per template to correlate, 0 per pruned one
+*   return: the number of templates kept
+****************************************************************************************/
+static INT8U CascadePrune(INT16S* const capture[], INT16U length, INT8U* keep) {
+    AXIS_FEATURES features[NUM_AXES];
+    INT8U far;
+    INT8U kept = 0;
+
+    for (INT8U axis = 0; axis < NUM_AXES; axis++) {
+        FeatureExtract(capture[axis], length, &features[axis]);
+    }
+    for (INT8U i = 0; i < NUM_DB_TRICKS; i++) {
+        far = 0;
+        for (INT8U axis = 0; axis < NUM_AXES; axis++) {
+            far += FeaturesFar(&features[axis], &Templates[i].features[axis]);
+        }
+        keep[i] = (far < MATCH_CASCADE_PRUNE) ? 1U : 0U;
+        kept += keep[i];
+    }
+    return kept;
+}
+
+/****************************************************************************************
+* FeatureExtract - Shape features of one axis that survive the capture's gain and offset.
+*                  One pass finds the mean and the extremes, a second one measures the
+*                  series against them.
+****************************************************************************************/
+static void FeatureExtract(const INT16S* series, INT16U length, AXIS_FEATURES* features) {
+    INT32S sum = 0;
+    INT16S max = series[0];
+    INT16S min = series[0];
+    INT16U maxIndex = 0;
+    INT16U minIndex = 0;
+    INT32S mean;
+    INT32S peak;
+    INT32S dev;
+    INT32U devSum = 0;
+    INT32S segmentSum = 0;
+    INT16U segmentLen = length / CASCADE_SEGMENTS;
+    INT16U segment = 0;
+
+    for (INT16U i = 0; i < length; i++) {
+        sum += series[i];
+        if (series[i] > max) {
+            max = series[i];
+            maxIndex = i;
+        } else if (series[i] < min) {
+            min = series[i];
+            minIndex = i;
+        } else {}
+    }
+    mean = sum / (INT32S)length;
+    if ((max - mean) >= (mean - min)) {
+        peak = max - mean;
+        features->peak = maxIndex;
+    } else {
+        peak = mean - min;
+        features->peak = minIndex;
+    }
+    features->signs = 0;
+    for (INT16U i = 0; i < length; i++) {
+        dev = series[i] - mean;
+        devSum += (INT32U)((dev < 0) ? -dev : dev);
+        segmentSum += dev;
+        if ((i + 1U) == ((segment + 1U) * segmentLen)) {
+            features->signs |= (segmentSum > 0) ? (INT8U)(1U << segment) : 0U;
+            segmentSum = 0;
+            segment++;
+        } else {}
+    }
+    features->energy = (peak > 0) ? (INT16U)(((devSum / length) << 8) / (INT32U)peak) : 0U;
+}
+
+/****************************************************************************************
+* FeaturesFar - Counts the features of one axis that are too far apart to belong to the
+*               same trick
+*   return: 0 to 3
+****************************************************************************************/
+static INT8U FeaturesFar(const AXIS_FEATURES* a, const AXIS_FEATURES* b) {
+    INT8U far = 0;
+    INT8U differ = a->signs ^ b->signs;
+    INT8U bits = 0;
+
+    while (differ != 0) {
+        bits += differ & 1U;
+        differ >>= 1;
+    }
+    far += (((a->energy > b->energy) ? (a->energy - b->energy) : (b->energy - a->energy)) > CASCADE_ENERGY_FAR) ? 1U : 0U;
+    far += (((a->peak > b->peak) ? (a->peak - b->peak) : (b->peak - a->peak)) > CASCADE_PEAK_FAR) ? 1U : 0U;
+    far += (bits > CASCADE_SIGNS_FAR) ? 1U : 0U;
+    return far;
+}
+#endif
+#endif
+
+#if MATCH_CORREL_EN
+/****************************************************************************************
+* AxesCorrel - Mean Q31 correlation over the three axes
+****************************************************************************************/
+static INT32S AxesCorrel(CORREL_SUMS* sums, INT16U length) {
+    INT64S total = 0;
+    for (INT8U axis = 0; axis < NUM_AXES; axis++) {
+        total += CorrelFromSums(&sums[axis], length);
+    }
+    return (INT32S)(total / NUM_AXES);
+}
+
+/****************************************************************************************
+* CorrelSums - Single pass over two series gathering every sum a Pearson correlation
+*              needs. Two samples of each series are loaded per word and accumulated with
+*              dual MACs, five MAC instructions per two samples.
+****************************************************************************************/
+static void CorrelSums(const INT16S* x, const INT16S* y, INT16U length, CORREL_SUMS* sums) {
+    INT64S sumXY = 0;
+    INT64S sumXX = 0;
+    INT64S sumYY = 0;
+    INT32S sumX = 0;
+    INT32S sumY = 0;
+    INT32U xPair, yPair;
+
+    for (INT16U i = length >> 1; i > 0; i--) {
+        xPair = Q15_PAIR_READ(x);
+        yPair = Q15_PAIR_READ(y);
+        x += 2;
+        y += 2;
+        sumXY = MAC_PAIR64(xPair, yPair, sumXY);
+        sumXX = MAC_PAIR64(xPair, xPair, sumXX);
+        sumYY = MAC_PAIR64(yPair, yPair, sumYY);
+        sumX = MAC_PAIR32(xPair, Q15_PAIR_ONES, sumX);
+        sumY = MAC_PAIR32(yPair, Q15_PAIR_ONES, sumY);
+    }
+    if ((length & 1U) != 0) {
+        INT32S xLast = *x;
+        INT32S yLast = *y;
+        sumXY += xLast * yLast;
+        sumXX += xLast * xLast;
+        sumYY += yLast * yLast;
+        sumX += xLast;
+        sumY += yLast;
+    } else {}
+    sums->sumXY = sumXY;
+    sums->sumXX = sumXX;
+    sums->sumYY = sumYY;
+    sums->sumX = sumX;
+    sums->sumY = sumY;
+}
+
+/****************************************************************************************
+* DotProduct - Sum of x[i]*y[i], two samples per dual MAC
+****************************************************************************************/
+static INT64S DotProduct(const INT16S* x, const INT16S* y, INT16U length) {
+    INT64S sum = 0;
+    INT32U xPair, yPair;
+    for (INT16U i = length >> 1; i > 0; i--) {
+        xPair = Q15_PAIR_READ(x);
+        yPair = Q15_PAIR_READ(y);
+        x += 2;
+        y += 2;
+        sum = MAC_PAIR64(xPair, yPair, sum);
+    }
+    if ((length & 1U) != 0) {
+        sum += (INT32S)*x * *y;
+    } else {}
+    return sum;
+}
+
+/****************************************************************************************
+* NormFromSums - sqrt of the mean-adjusted sum of squares >> 15
+****************************************************************************************/
+static INT32U NormFromSums(INT64S sum, INT64S sos, INT16U length) {
+    INT64S adjusted = sos - ((sum * sum) / length);
+    if (adjusted < 0) {
+        adjusted = 0;
+    } else {}
+    return SquareRoot((INT64U)(adjusted >> 15));
+}
+
+/****************************************************************************************
+* CorrelFromSums - Q31 Pearson correlation of two series from their CorrelSums()
+****************************************************************************************/
+static INT32S CorrelFromSums(CORREL_SUMS* sums, INT16U length) {
+    INT64S dot = sums->sumXY - (((INT64S)sums->sumX * sums->sumY) / length);
+    return CorrelCoeff(dot, NormFromSums(sums->sumX, sums->sumXX, length),
+                       NormFromSums(sums->sumY, sums->sumYY, length));
+}
+
+/****************************************************************************************
+* CorrelCoeff - Q31 correlation coefficient from a mean-adjusted dot product and the
+*               two norms, saturated to +/-1.0
+****************************************************************************************/
+static INT32S CorrelCoeff(INT64S dot, INT32U captureNorm, INT32U templateNorm) {
+    INT32S numerator = (INT32S)(dot >> 15);
+    INT64S denominator = (INT64S)captureNorm * templateNorm;
+    INT64S coeff;
+    if (denominator == 0) {
+        coeff = 0;
+    } else {
+        coeff = ((INT64S)numerator * (1LL << 31)) / denominator;
+        if (coeff > INT32_MAX) {        // Rounding can push a perfect match just past 1.0
+            coeff = INT32_MAX;
+        } else if (coeff < -INT32_MAX) {
+            coeff = -INT32_MAX;
+        } else {}
+    }
+    return (INT32S)coeff;
+}
+#endif
+
+/****************************************************************************************
+* SquareRoot - Integer square root on the FPU. The input is shifted right by an even
+*              amount, found with CLZ, until it fits the 24-bit float mantissa, so
+*              VSQRT.F32 returns the root of the top bits and the shift is undone by
+*              half before rounding, keeping the root to 24 significant bits. Plenty
+*              for correlation denominators, and a few cycles instead of the 32
+*              iterations of the bit-by-bit loop.
+****************************************************************************************/
+static INT32U SquareRoot(INT64U a_nInput) {
+    INT32U high = (INT32U)(a_nInput >> 32);
+    INT32U low = (INT32U)a_nInput;
+    INT8U shift;
+    FP32 root;
+
+    if (high != 0) {
+        shift = (INT8U)(64U - __CLZ(high));
+    } else if (low != 0) {
+        shift = (INT8U)(32U - __CLZ(low));
+    } else {
+        shift = 0;
+    }
+    shift = (shift > 24U) ? (INT8U)((shift - 23U) & ~1U) : 0U;   // Even, leaves at most 24 bits
+    (void)arm_sqrt_f32((FP32)(INT32U)(a_nInput >> shift), &root);
+    root *= (FP32)(1UL << (shift >> 1));    // Exact, a power of 2
+    return (root < 4294967296.0f) ? (INT32U)(root + 0.5f) : 0xFFFFFFFFU;   // Rounds up near 2^64
+}
+
+#if TRICK_BENCH_EN
+/****************************************************************************************
+* TrickMatchBenchmark - Prints DWT cycle counts of the correlation kernels against the
+*                       original implementation, the cost of one direct lag step and,
+*                       with the FFT engine, the lag where the FFT becomes cheaper
+****************************************************************************************/
+void TrickMatchBenchmark(void) {
+    INT16S* x = (INT16S*)TRICK_DB[0][0];
+    INT16S* y = (INT16S*)TRICK_DB[NUM_DB_TRICKS - 1][0];
+    CORREL_SUMS sums;
+    CORREL_SUMS lagSums[NUM_AXES];
+    INT16S* capture[NUM_AXES];
+    TRICK_MATCH match;
+    INT32U start;
+    INT32U cycles;
+    INT32U lagCycles;
+    volatile INT32S corr;
+    volatile INT64U root;
+
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    start = DWT->CYCCNT;
+    corr = LegacyCorrelCoeff(x, y);
+    cycles = DWT->CYCCNT - start;
+    BenchPrint("Legacy CorrelCoeff: ", cycles);
+
+    start = DWT->CYCCNT;
+    CorrelSums(x, y, SAMPLES_PER_BLOCK, &sums);
+    corr = CorrelFromSums(&sums, SAMPLES_PER_BLOCK);
+    cycles = DWT->CYCCNT - start;
+    BenchPrint("CorrelSums+CorrelFromSums: ", cycles);
+
+    start = DWT->CYCCNT;
+    corr = (INT32S)DotProduct(x, y, SAMPLES_PER_BLOCK);
+    cycles = DWT->CYCCNT - start;
+    BenchPrint("DotProduct: ", cycles);
+
+    /* One step of the direct lag search: a dot product per axis and the correlation */
+    for (INT8U axis = 0; axis < NUM_AXES; axis++) {
+        capture[axis] = (INT16S*)TRICK_DB[0][axis];
+        CorrelSums(capture[axis], TRICK_DB[NUM_DB_TRICKS - 1][axis], SAMPLES_PER_BLOCK, &lagSums[axis]);
+    }
+    start = DWT->CYCCNT;
+    for (INT8U axis = 0; axis < NUM_AXES; axis++) {
+        lagSums[axis].sumXY = DotProduct(&capture[axis][1], TRICK_DB[NUM_DB_TRICKS - 1][axis], SAMPLES_PER_BLOCK - 1);
+    }
+    corr = AxesCorrel(lagSums, SAMPLES_PER_BLOCK - 1);
+    lagCycles = DWT->CYCCNT - start;
+    BenchPrint("Direct, per lag and template: ", lagCycles);
+
+#if MATCH_ENGINE == MATCH_ENGINE_DIRECT
+    const INT16S* tmpl[NUM_AXES] = {TRICK_DB[NUM_DB_TRICKS - 1][0], TRICK_DB[NUM_DB_TRICKS - 1][1],
+                                    TRICK_DB[NUM_DB_TRICKS - 1][2]};
+    start = DWT->CYCCNT;
+    TemplateMatch(capture, tmpl, SAMPLES_PER_BLOCK, MATCH_MAX_LAG, lagSums, &match);
+    cycles = DWT->CYCCNT - start;
+    BenchPrint("TemplateMatch, all lags: ", cycles);
+#if MATCH_INCREMENTAL_EN
+    ACCEL_DATA_3D sample = {x[SAMPLES_PER_BLOCK / 2], x[SAMPLES_PER_BLOCK / 2], x[SAMPLES_PER_BLOCK / 2]};
+    start = DWT->CYCCNT;
+    TrickMatchAccumulate(&sample, SAMPLES_PER_BLOCK / 2);
+    cycles = DWT->CYCCNT - start;
+    BenchPrint("TrickMatchAccumulate, per sample: ", cycles);
+    start = DWT->CYCCNT;
+    for (INT8U axis = 0; axis < NUM_AXES; axis++) {
+        LagWindowStats(capture[axis], SAMPLES_PER_BLOCK, 1, CaptureLagSum[axis], CaptureLagInvNorm[axis]);
+    }
+    for (INT8U i = 0; i < NUM_DB_TRICKS; i++) {
+        corr = IncrementalMatch(i, SAMPLES_PER_BLOCK, TemplateLagSum[i], TemplateLagInvNorm[i], &match);
+    }
+    cycles = DWT->CYCCNT - start;
+    BenchPrint("Incremental normalization, all templates: ", cycles);
+#if MATCH_EARLY_EN
+    /* What TrickIdentifyEarly() does at the first check, the later ones grow with count */
+    start = DWT->CYCCNT;
+    for (INT8U axis = 0; axis < NUM_AXES; axis++) {
+        LagWindowStats(capture[axis], MATCH_EARLY_MIN_SAMPLES, 1, CaptureLagSum[axis], CaptureLagInvNorm[axis]);
+    }
+    for (INT8U i = 0; i < NUM_DB_TRICKS; i++) {
+        for (INT8U axis = 0; axis < NUM_AXES; axis++) {
+            LagWindowStats(Templates[i].samples[axis], MATCH_EARLY_MIN_SAMPLES, 0, ProgressLagSum[axis],
+                           ProgressLagInvNorm[axis]);
+        }
+        corr = IncrementalMatch(i, MATCH_EARLY_MIN_SAMPLES, ProgressLagSum, ProgressLagInvNorm, &match);
+    }
+    cycles = DWT->CYCCNT - start;
+    BenchPrint("Early check, all templates: ", cycles);
+#endif
+#elif MATCH_COARSE_TOP_K > 0
+    TRICK_MATCH coarse[NUM_DB_TRICKS];
+    INT8U keepAll[NUM_DB_TRICKS];
+    for (INT8U i = 0; i < NUM_DB_TRICKS; i++) {
+        keepAll[i] = 1;
+    }
+    start = DWT->CYCCNT;
+    CoarseRank(capture, keepAll, coarse);
+    cycles = DWT->CYCCNT - start;
+    BenchPrint("CoarseRank, all templates: ", cycles);
+#endif
+#if MATCH_CASCADE_EN
+    /* Every recording, whole and cut MATCH_MAX_LAG short at either end, against every
+     * template. A recording pruned from its own template is a lost match. */
+    INT8U keep[NUM_DB_TRICKS];
+    INT16U offset;
+    INT32U pruned = 0;
+    INT32U lost = 0;
+    INT32U cascadeCycles = 0;
+    for (INT8U c = 0; c < NUM_DB_TRICKS; c++) {
+        for (INT8U cut = 0; cut < 3; cut++) {
+            offset = (cut == 1) ? MATCH_MAX_LAG : 0;
+            for (INT8U axis = 0; axis < NUM_AXES; axis++) {
+                capture[axis] = (INT16S*)&TRICK_DB[c][axis][offset];
+            }
+            start = DWT->CYCCNT;
+            pruned += NUM_DB_TRICKS - CascadePrune(capture, (cut == 0) ? SAMPLES_PER_BLOCK :
+                                                   (SAMPLES_PER_BLOCK - MATCH_MAX_LAG), keep);
+            cascadeCycles += DWT->CYCCNT - start;
+            lost += (keep[c] == 0) ? 1U : 0U;
+        }
+    }
+    BenchPrint("CascadePrune, per capture: ", cascadeCycles / (3U * NUM_DB_TRICKS));
+    BenchPrint("Cascade pruned, of templates x recordings: ", pruned);
+    BenchPrint("  out of: ", 3U * NUM_DB_TRICKS * NUM_DB_TRICKS);
+    BenchPrint("  own template pruned: ", lost);
+#endif
+#elif MATCH_ENGINE == MATCH_ENGINE_FFT
+    /* The FFT cost per template is fixed, the direct one is (2 * lag + 1) steps */
+    start = DWT->CYCCNT;
+    CaptureSpectra(capture);
+    cycles = DWT->CYCCNT - start;
+    BenchPrint("CaptureSpectra: ", cycles);
+    cycles /= NUM_DB_TRICKS;
+    start = DWT->CYCCNT;
+    SpectrumMatch(capture, NUM_DB_TRICKS - 1, &match);
+    cycles += DWT->CYCCNT - start;
+    BenchPrint("FFT, per template: ", cycles);
+    BenchPrint("Crossover MATCH_MAX_LAG: ", ((cycles / lagCycles) - 1U) / 2U);
+#else
+    start = DWT->CYCCNT;
+    (void)DtwIdentify(capture, &match);
+    cycles = DWT->CYCCNT - start;
+    BenchPrint("DtwIdentify: ", cycles);
+    start = DWT->CYCCNT;
+    (void)DtwDistance(&Templates[NUM_DB_TRICKS - 1], DTW_INF);
+    cycles = DWT->CYCCNT - start;
+    BenchPrint("DtwDistance, unbounded: ", cycles);
+    BenchPrint("DTW runs: ", DtwRuns);
+    BenchPrint("DTW pruned: ", DtwPruned);
+#endif
+
+    start = DWT->CYCCNT;
+    root = LegacySquareRoot(0x0123456789ULL);
+    cycles = DWT->CYCCNT - start;
+    BenchPrint("Legacy SquareRoot: ", cycles);
+
+    start = DWT->CYCCNT;
+    root = SquareRoot(0x0123456789ULL);
+    cycles = DWT->CYCCNT - start;
+    BenchPrint("SquareRoot: ", cycles);
+    (void)corr;
+    (void)root;
+    (void)match;
+}
+
+/****************************************************************************************
+* BenchPrint - One labeled cycle count per line
+****************************************************************************************/
+static void BenchPrint(const INT8C* label, INT32U cycles) {
+    BIOPutStrg(label);
+    BIOOutDecWord(cycles, 1);
+    BIOOutCRLF();
+}
+
+/****************************************************************************************
+* LegacyCorrelCoeff - The original four pass CorrelCoeff, kept only as the benchmark
+*                     baseline. Needs 19.2 KB of stack.
+****************************************************************************************/
+static INT32S LegacyCorrelCoeff(INT16S* curr_data_buffer, INT16S* db_buffer) {
+    int16_t mean_db, mean_curr;
+
+    int32_t adj_db[SAMPLES_PER_BLOCK];
+    int32_t adj_curr[SAMPLES_PER_BLOCK];
+
+    int32_t product_db_curr[SAMPLES_PER_BLOCK];
+
+    arm_mean_q15(db_buffer, SAMPLES_PER_BLOCK, &mean_db);
+    arm_mean_q15(curr_data_buffer, SAMPLES_PER_BLOCK, &mean_curr);
+
+    for (INT16U i = 0; i < SAMPLES_PER_BLOCK; i++) {
+        adj_db[i] = (int32_t)((int32_t)db_buffer[i] - (int32_t)mean_db);
+
+        adj_curr[i] = (int32_t)((int32_t)curr_data_buffer[i] - (int32_t)mean_curr);
+    }
+
+    for (INT16U i = 0; i < SAMPLES_PER_BLOCK; i++) {
+        product_db_curr[i] = adj_db[i] * adj_curr[i];
+    }
+
+    int64_t sum = 0;
+    for (INT16U i = 0; i < SAMPLES_PER_BLOCK; i++) {
+        sum += product_db_curr[i];
+    }
+    int32_t numerator = (int32_t)(sum >> 15);
+
+    int64_t sos_db, sos_curr;
+    for (INT16U i = 0; i < SAMPLES_PER_BLOCK; i++) {
+        adj_db[i] = adj_db[i] * adj_db[i];
+        adj_curr[i] = adj_curr[i] * adj_curr[i];
+    }
+    sos_db = 0;
+    sos_curr = 0;
+    for (INT16U i = 0; i < SAMPLES_PER_BLOCK; i++) {
+        sos_db += adj_db[i];
+        sos_curr += adj_curr[i];
+    }
+
+    int32_t sos_db_scaled = (int32_t)(sos_db >> 15);
+    int32_t sos_curr_scaled = (int32_t)(sos_curr >> 15);
+    uint64_t bottom_product = (uint64_t) sos_db_scaled * sos_curr_scaled;
+
+    int32_t denominator;
+    denominator = (int32_t)LegacySquareRoot(bottom_product);
+
+    return (int32_t)(((int64_t)numerator * (1UL << 31)) / denominator);
+}
+
+/****************************************************************************************
+* LegacySquareRoot - The original bit-by-bit integer square root, benchmark baseline
+* https://stackoverflow.com/questions/1100090/looking-for-an-efficient-integer-square-root-algorithm-for-arm-thumb2
+****************************************************************************************/
+static INT64U LegacySquareRoot(INT64U a_nInput)
+{
+    INT64U op  = a_nInput;
+    INT64U res = 0;
+    INT64U one = 1ULL << 62;
+
+    while (one > op) {
+        one >>= 2;
+    }
+
+    while (one != 0) {
+        if (op >= res + one) {
+            op = op - (res + one);
+            res = res +  2 * one;
+        }
+        res >>= 1;
+        one >>= 2;
+    }
+    return res;
+}
+#endif
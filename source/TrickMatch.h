@@ -0,0 +1,151 @@
+/****************************************************************************************
+ * DESCRIPTION: Header for trick classification against the TRICK_DB templates.
+ *              Settings in #ifndef can be given on the compiler command line,
+ *              tools/trickmatch_host/run.sh checks several of them on a host.
+ * AUTHOR: Neal Crawford
+ * HISTORY: Started 10/16/2026
+ ***************************************************************************************/
+#ifndef TRICK_MATCH_DEF
+#define TRICK_MATCH_DEF
+
+#define SAMPLES_PER_BLOCK 1600 // Two seconds of acceleration data
+
+/* Largest offset, in samples, searched either way between a capture and a template.
+ * 0 compares at zero offset only. */
+#ifndef MATCH_MAX_LAG
+#define MATCH_MAX_LAG 80
+#endif
+
+/* Matching engine. DIRECT slides each template over the capture, its cost grows with
+ * MATCH_MAX_LAG. FFT cross-correlates in the frequency domain at a fixed cost for any
+ * lag up to MATCH_FFT_LEN - SAMPLES_PER_BLOCK. TrickMatchBenchmark() prints the crossover
+ * when built with the FFT engine. DTW compares decimated data with dynamic time warping,
+ * so a trick done faster or slower than its template still matches. */
+#define MATCH_ENGINE_DIRECT 0
+#define MATCH_ENGINE_FFT    1
+#define MATCH_ENGINE_DTW    2
+#ifndef MATCH_ENGINE
+#define MATCH_ENGINE MATCH_ENGINE_DIRECT
+#endif
+#define MATCH_FFT_LEN 2048
+
+/* Direct engine: templates are first ranked on data decimated by MATCH_COARSE_DECIMATE,
+ * then only the best MATCH_COARSE_TOP_K are rescored at full rate around their coarse
+ * offset. 0 rescores every template over the whole lag window. */
+#define MATCH_COARSE_DECIMATE 8
+#ifndef MATCH_COARSE_TOP_K
+#define MATCH_COARSE_TOP_K    2
+#endif
+
+/* Direct engine: 1 accumulates every template's dot products at every lag as each sample
+ * is recorded, see TrickMatchAccumulate(). TrickIdentify() is then left with only the
+ * normalization. Costs (2 * MATCH_MAX_LAG + 1) MACs per template axis per sample, so it
+ * suits a small TRICK_DB, and replaces the coarse ranking. */
+#ifndef MATCH_INCREMENTAL_EN
+#define MATCH_INCREMENTAL_EN 0
+#endif
+
+/* Direct engine, burst modes: 1 compares a few cheap features of the capture with each
+ * template's before correlating, see CascadePrune(). Templates where at least
+ * MATCH_CASCADE_PRUNE of the 9 axis feature comparisons are far off are skipped.
+ * TrickMatchBenchmark() prints the prune rate over the TRICK_DB recordings, and
+ * tools/trickmatch_host checks it over shifted, attenuated and noisy ones. */
+#ifndef MATCH_CASCADE_EN
+#define MATCH_CASCADE_EN    0
+#endif
+#define MATCH_CASCADE_PRUNE 5
+
+/* Incremental mode: 1 also scores the capture every MATCH_EARLY_STEP samples once
+ * MATCH_EARLY_MIN_SAMPLES are in, see TrickIdentifyEarly(). A trick is decided early when
+ * its correlation passes MATCH_THRESHOLD and leads the runner-up by MATCH_EARLY_MARGIN,
+ * in Q31. Each check costs about one TrickIdentify() normalization per template. */
+#ifndef MATCH_EARLY_EN
+#define MATCH_EARLY_EN          0
+#endif
+#define MATCH_EARLY_STEP        100
+#define MATCH_EARLY_MIN_SAMPLES 300
+#define MATCH_EARLY_MARGIN      (1 << 29)   // 0.25
+
+/* DTW engine: decimation of the 800 Hz data, Sakoe-Chiba band half width in decimated
+ * samples, and the largest mean warped distance that is still a match. Distances are
+ * the absolute differences of z-normalized axes in Q12, summed over the three axes. */
+#define MATCH_DTW_DECIMATE  8
+#define MATCH_DTW_BAND      20
+#define MATCH_DTW_THRESHOLD 5120
+
+/* 1: TrickMatchBenchmark() is built and run at boot */
+#ifndef TRICK_BENCH_EN
+#define TRICK_BENCH_EN 0
+#endif
+
+typedef struct {
+	INT16S samplesX[SAMPLES_PER_BLOCK];
+	INT16S samplesY[SAMPLES_PER_BLOCK];
+	INT16S samplesZ[SAMPLES_PER_BLOCK];
+
+	INT16S absX[SAMPLES_PER_BLOCK];
+	INT16S absY[SAMPLES_PER_BLOCK];
+	INT16S absZ[SAMPLES_PER_BLOCK];
+} ACCEL_BUFFERS;
+
+typedef struct {
+	INT32S corr;    // Mean Q31 correlation over the three axes
+	INT16S lag;     // Capture offset in samples, positive when the capture is late
+	INT32U distance;    // DTW engine only, mean warped distance per decimated sample
+	INT16U samples;     // Samples of the capture the decision was made on
+} TRICK_MATCH;
+
+/****************************************************************************************
+* Public Functions
+*****************************************************************************************
+* TrickMatchInit - Prepare the TRICK_DB templates once at boot. Must be called before
+*                  TrickIdentify() and after CrcInit().
+****************************************************************************************/
+void TrickMatchInit(void);
+
+/****************************************************************************************
+* TrickMatchDbCheck - Checks the CRC of TRICK_DB computed by TrickMatchInit()
+*   crc: set to the CRC computed
+*   return: 1 if it is TRICK_DB_CRC, 0 if the templates in flash are corrupt or were
+*           changed without updating TRICK_DB_CRC
+****************************************************************************************/
+INT8U TrickMatchDbCheck(INT16U* crc);
+
+/****************************************************************************************
+* TrickIdentify - Identifies the most likely trick match between last recorded movement
+*                 and the trick database, searching +/-MATCH_MAX_LAG samples of offset
+*   match: filled with the correlation and offset of the best scoring template
+*   return: 1 based TRICK_DB index of the match, 0 if nothing matched well enough
+****************************************************************************************/
+INT32U TrickIdentify(ACCEL_BUFFERS* buffer, TRICK_MATCH* match);
+
+#if MATCH_INCREMENTAL_EN
+/****************************************************************************************
+* TrickMatchAccumulate - Adds one recorded sample to the running dot products. Call for
+*                        every sample of a capture in order, index 0 starts a new one.
+*                        TrickIdentify() must then get the raw, unscaled capture.
+****************************************************************************************/
+void TrickMatchAccumulate(const ACCEL_DATA_3D* sample, INT16U index);
+#endif
+
+#if MATCH_EARLY_EN
+/****************************************************************************************
+* TrickIdentifyEarly - Scores the first count samples of a capture still being recorded,
+*                      after TrickMatchAccumulate() has seen them. Only does the work when
+*                      count is a multiple of MATCH_EARLY_STEP.
+*   match: filled as by TrickIdentify(), samples set to count
+*   return: 1 based TRICK_DB index once one trick clearly leads, 0 while undecided
+****************************************************************************************/
+INT32U TrickIdentifyEarly(ACCEL_BUFFERS* buffer, INT16U count, TRICK_MATCH* match);
+#endif
+
+#if TRICK_BENCH_EN
+/****************************************************************************************
+* TrickMatchBenchmark - Prints DWT cycle counts of the correlation kernels against the
+*                       original CorrelCoeff/SquareRoot and the direct/FFT engine
+*                       crossover. Call after TrickMatchInit().
+****************************************************************************************/
+void TrickMatchBenchmark(void);
+#endif
+
+#endif
@@ -6,29 +6,106 @@
 #include "MCUType.h"
 #include "K22FRDM_ClkCfg.h"
 #include "K22FRDM_GPIO.h"
+#include "K22FRDM_Power.h"
 #include "FXOS8700CQ.h"
+#include "AccelSampler.h"
 #include "BasicIO.h"
-#include "TrickDB.h"
+#include "TrickMatch.h"
+#include "Telemetry.h"
+#include "Crc.h"
+#include <cr_section_macros.h>
 
-#define LDVAL_800HZ 62499   // (50MHz / 800 Hz) - 1
 #define Q_MAX 32767U
 
+/* Power management: 1 sleeps in wait mode whenever the event loop is out of work and
+ * stops while the sampler is armed, see SAMPLER_HW_TRIGGER_EN. Time in each state is
+ * printed with the results. */
+#define POWER_MGMT_EN 1
+
+/* Clock scaling: 1 idles in VLPR at 4MHz while waiting for a trigger and switches to the
+ * CLOCK_SETUP clocks to record and identify a capture, see K22FRDM_ClkCfg.h. */
+#define CLOCK_SCALING_EN 1
+
+/* Recordings: 1 sends approved captures as binary telemetry frames, decode them with
+ * tools/telemetry_decode.py. 0 prints them as hex text, as TRICK_DB was recorded. */
+#define TELEMETRY_BINARY_EN 1
+#define SAMPLE_RATE_HZ      800U
+
+/* Live streaming: 1 sends every sample as delta coded telemetry frames, about 3 KB/s
+ * for 4.8 KB/s of samples, alongside the normal output. The compression ratio is printed
+ * with the results. */
+#define TELEMETRY_STREAM_EN 0
+
+/* Bytes sent by the BasicIO throughput test at start-up, see BIO_SELF_TEST_EN. Each
+ * second of the test is BIOGetBaud() / 10 bytes at full speed. */
+#define BIO_SELF_TEST_BYTES 16384U
+
+/* Null-class gate: 1 checks the first NULL_GATE_SAMPLES of each capture and drops it
+ * when the variance summed over the three axes stays below NULL_GATE_MIN_STD squared.
+ * A kick or bump trips the trigger with one spike and settles, a trick keeps moving.
+ * Template recordings (SW3) are never dropped. The first 80 samples of the TRICK_DB
+ * recordings measure 1989, 2246 and 3156. 1000 leaves the slowest start 2x, and is still
+ * above the ~600 of a 3 sample spike just big enough to trip the adaptive trigger. */
+#define NULL_GATE_EN      1
+#define NULL_GATE_SAMPLES 80U       // 100mS at 800 Hz
+#define NULL_GATE_MIN_STD 1000      // In sample counts
+
+/* Adaptive trigger: 1 keeps an exponentially weighted mean and variance of each axis
+ * while idle and fires when a sample is TRIGGER_K standard deviations off the mean, or
+ * TRIGGER_K * TRIGGER_MIN_STD on a quiet board. 0 uses the fixed thresholds. Neither
+ * is used when the FXOS triggers, see SAMPLER_HW_TRIGGER_EN. */
+#define TRIGGER_ADAPTIVE_EN 1
+#define TRIGGER_EWMA_SHIFT  7U      // Weight 1/128, 160mS time constant at 800 Hz
+#define TRIGGER_MEAN_FRAC   8U      // Fraction bits of the running mean
+#define TRIGGER_K           6
+#define TRIGGER_MIN_STD     500     // In sample counts
+#define TRIGGER_WARMUP      800U    // Samples learned before the first trigger, 1S
+
+/* Triggering samples are kept out of the baseline, so a lasting change such as the board
+ * turned over would trigger on every sample. The baseline is learned again from the next
+ * sample after a capture the null-class gate dropped or nothing matched. */
+#if TRIGGER_ADAPTIVE_EN && !SAMPLER_HW_TRIGGER_EN
+#define TRIGGER_RELEARN()   (TriggerWarmup = TRIGGER_WARMUP)
+#else
+#define TRIGGER_RELEARN()   ((void)0)
+#endif
+
+/* Samples from before the trigger put at the start of each capture, so a trick's wind-up
+ * is matched too, 160 is 200mS at 800 Hz. 0 starts captures on the trigger sample, as
+ * TRICK_DB was recorded. Re-record TRICK_DB after changing it. */
+#define PRE_TRIGGER_SAMPLES 0U
+#define PRE_TRIGGER_SIZE    256U    // Must be a power of 2 and hold PRE_TRIGGER_SAMPLES
+#define PRE_TRIGGER_MASK    (PRE_TRIGGER_SIZE - 1U)
+#if (PRE_TRIGGER_SAMPLES > PRE_TRIGGER_SIZE) || (PRE_TRIGGER_SAMPLES >= SAMPLES_PER_BLOCK)
+#error "PRE_TRIGGER_SAMPLES must fit PRE_TRIGGER_SIZE and leave room in the block"
+#endif
+#if SAMPLE_QUEUE_SIZE >= SAMPLES_PER_BLOCK
+#error "FillAccelBuffers() needs the ready buffer processed before the next capture fills"
+#endif
+
 /*****************************************************************************************
 * Function Prototypes
 *****************************************************************************************/
-static void PITInit(void);
-static void PITPend(void);
 static INT16U CalculateScore(ACCEL_BUFFERS* buffer);
+#if !SAMPLER_HW_TRIGGER_EN
 static INT8U AccelTriggered(ACCEL_DATA_3D* AccelData3D);
+#endif
+#if !TELEMETRY_BINARY_EN
 static void PrintAccelBuffers(ACCEL_BUFFERS* buffer);
+#endif
 static void FillAccelBuffers(ACCEL_DATA_3D* AccelData3D, ACCEL_BUFFERS* buffer, INT16U* bufferIndexPtr);
-static INT32U TrickIdentify(ACCEL_BUFFERS* buffer);
+#if !MATCH_INCREMENTAL_EN
 static void NormalizeAccelData(ACCEL_BUFFERS* buffer);
-static void AccelDataAbsoluteValues(ACCEL_BUFFERS* buffer);
-static INT32S CorrelCoeff(INT16S* curr_data_buffer, INT16S* db_buffer);
-static INT64U SquareRoot(INT64U a_nInput);
 static INT8U Log2(INT16U x);
-static void LoadDBBuffer(ACCEL_BUFFERS* buffer, INT8U trick_index);
+#endif
+static void AccelDataAbsoluteValues(ACCEL_BUFFERS* buffer);
+static void PrintTrick(INT32U trick_id, const TRICK_MATCH* match);
+#if PRE_TRIGGER_SAMPLES > 0
+static void PreTriggerStitch(ACCEL_BUFFERS* buffer, INT16U* bufferIndexPtr);
+#endif
+#if NULL_GATE_EN
+static INT8U NullGateReject(ACCEL_DATA_3D* AccelData3D, INT16U count);
+#endif
 
 /*****************************************************************************************/
 
@@ -36,7 +113,36 @@ static void LoadDBBuffer(ACCEL_BUFFERS* buffer, INT8U trick_index);
 /*****************************************************************************************
 * Static file variables
 *****************************************************************************************/
+/* Ping-pong capture buffers: queued samples fill SampleData[FillBuffer] while the
+ * main loop processes SampleData[ReadyBuffer]. Placed in SRAM_LOWER to keep the
+ * stack in SRAM_UPPER free for TrickIdentify(). */
+__BSS(RAM2) static ACCEL_BUFFERS SampleData[2];
+static INT8U FillBuffer;
+static INT8U ReadyBuffer;
 static INT8U ProcessFlag;
+static INT8U RecordAccel;
+static INT16U BufferIndex;
+static INT8U BackNForthCount;
+static INT8U BarrelRollCount;
+static INT8U Spin180Count;
+static INT16U CompletedCaptures;  // Captures that filled a buffer
+#if PRE_TRIGGER_SAMPLES > 0
+static ACCEL_DATA_3D PreTrigger[PRE_TRIGGER_SIZE];  // Every sample, the newest at PreTriggerHead - 1
+static INT16U PreTriggerHead;
+#endif
+#if TRIGGER_ADAPTIVE_EN && !SAMPLER_HW_TRIGGER_EN
+static INT32S TriggerMean[3];     // Running mean << TRIGGER_MEAN_FRAC, x y z
+static INT32S TriggerVar[3];      // Running variance
+static INT16U TriggerWarmup;      // Samples left before triggering is allowed
+#endif
+#if NULL_GATE_EN
+static INT16U AbortedCaptures;    // Captures dropped by NullGateReject()
+static INT32S GateSum[3];         // Running sums over the gate window, x y z
+static INT64S GateSos[3];
+#endif
+#if MATCH_EARLY_EN
+static INT8U EarlyDecided;        // The capture being recorded was already identified
+#endif
 /*****************************************************************************************/
 
 
@@ -50,101 +156,264 @@ void main(void) {
     //GpioDBugBitsInit();
     GpioSwitchInit();
     BIOOpen(BIO_BIT_RATE_115200);
+#if POWER_MGMT_EN
+    PowerInit();
+#endif
     //BluetoothInit();
+    CrcInit();
     AccelInit();
+    TrickMatchInit();
+    if (CrcSelfTest() != 0) {
+        BIOPutStrg("CRC self-test failed");
+        BIOOutCRLF();
+    } else {}
+    {
+        INT16U dbCrc;
+        if (TrickMatchDbCheck(&dbCrc) == 0) {
+            BIOPutStrg("TRICK_DB CRC error: ");
+            BIOOutHexHWord(dbCrc);
+            BIOOutCRLF();
+        } else {}
+    }
+#if TRICK_BENCH_EN
+    TrickMatchBenchmark();
+#endif
+#if BIO_SELF_TEST_EN
+    {
+        INT32U bytesPerSec = BIOThroughputTest(BIO_SELF_TEST_BYTES);
+        BIOPutStrg("BIO baud, B/s: ");
+        BIOOutDecWord(BIOGetBaud(), 1);
+        BIOWrite(' ');
+        BIOOutDecWord(bytesPerSec, 1);
+        BIOOutCRLF();
+    }
+#endif
 
     ProcessFlag = 0;
-    INT8U backNForthCount = 0;
-    INT8U barrelRollCount = 0;
-    INT8U spin180Count = 0;
+    FillBuffer = 0;
+    ReadyBuffer = 1;
+    RecordAccel = 0;
+    BufferIndex = 0;
+    BackNForthCount = 0;
+    BarrelRollCount = 0;
+    Spin180Count = 0;
+    CompletedCaptures = 0;
+#if PRE_TRIGGER_SAMPLES > 0
+    PreTriggerHead = 0;
+#endif
+#if TRIGGER_ADAPTIVE_EN && !SAMPLER_HW_TRIGGER_EN
+    TriggerWarmup = TRIGGER_WARMUP;
+#endif
+#if NULL_GATE_EN
+    AbortedCaptures = 0;
+#endif
+#if MATCH_EARLY_EN
+    EarlyDecided = 0;
+#endif
     INT16U currentScore = 0;
-    INT16U bufferIndex = 0;
-    INT8U RecordAccel = 0;
     INT8U RECORD = 0;
-    ACCEL_DATA_3D CurrAccelSample;
-    ACCEL_BUFFERS SampleData;
-
-    PITInit();
-    while (1) { // Event loop
+    ACCEL_DATA_3D currAccelSample;
+    ACCEL_BUFFERS* readyData;
+    ACCEL_SAMPLER_STATS samplerStats;
+    TRICK_MATCH trickMatch;
+    INT32U trickId = 0;
+#if POWER_MGMT_EN
+    INT32U powerMs[POWER_NUM_STATES];
+#endif
+#if BIO_TX_BUFFERED_EN
+    BIO_TX_STATS txStats;
+#endif
+#if TELEMETRY_STREAM_EN
+    TELEM_STREAM_STATS streamStats;
+    INT32U streamRatio;
+#endif
+
+#if TELEMETRY_STREAM_EN
+    TelemetryStreamStart(SAMPLE_RATE_HZ);
+#endif
+    AccelSamplerInit();
+    while (1) { // Event loop, sampling continues in the background while data is processed
         if (GpioSW3Read()) {
             RECORD = 1;
             LEDBLUE_TURN_ON();
         }
-        if (ProcessFlag == 1) { // Begin processing accel. data, pause sampling new data until this is finished
+        while (AccelSamplerGet(&currAccelSample)) { // Catch up on samples queued since the last pass
+#if TELEMETRY_STREAM_EN
+            TelemetryStreamSample(currAccelSample.x, currAccelSample.y, currAccelSample.z);
+#endif
+#if SAMPLER_HW_TRIGGER_EN
+            if (!RecordAccel && AccelSamplerTriggered()) {  // The FXOS detected a transient, record the next two seconds
+#else
+            if (!RecordAccel && AccelTriggered(&currAccelSample)) { // If significant movement is detected, begin recording the next two seconds of movement
+#endif
+                RecordAccel = 1;
+                LEDBLUE_TURN_OFF();
+                LEDRED_TURN_ON();
+#if PRE_TRIGGER_SAMPLES > 0
+                PreTriggerStitch(&SampleData[FillBuffer], &BufferIndex);
+#endif
+            }
+#if PRE_TRIGGER_SAMPLES > 0
+            PreTrigger[PreTriggerHead & PRE_TRIGGER_MASK] = currAccelSample;
+            PreTriggerHead++;
+#endif
+
+            if (RecordAccel == 1) {
+                FillAccelBuffers(&currAccelSample, &SampleData[FillBuffer], &BufferIndex);
+#if NULL_GATE_EN
+                if ((RECORD == 0) && NullGateReject(&currAccelSample, BufferIndex - PRE_TRIGGER_SAMPLES)) {    // Not a trick, re-arm now
+                    AbortedCaptures++;
+                    TRIGGER_RELEARN();
+                    RecordAccel = 0;
+                    BufferIndex = 0;
+                    LEDRED_TURN_OFF();
+                    continue;
+                } else {}
+#endif
+#if MATCH_INCREMENTAL_EN
+                if (ProcessFlag == 1) {
+                    break;      // Identify before a new capture restarts the accumulation
+                } else {}
+#endif
+#if MATCH_EARLY_EN
+                /* Keep recording after a decision so the trick's tail does not retrigger */
+                if ((RECORD == 0) && (EarlyDecided == 0) && (BufferIndex != 0)) {
+                    INT32U early_id = TrickIdentifyEarly(&SampleData[FillBuffer], BufferIndex, &trickMatch);
+                    if (early_id != 0) {
+                        EarlyDecided = 1;
+                        trickId = early_id;
+                        PrintTrick(early_id, &trickMatch);
+                        BIOOutCRLF();
+                    } else {}
+                } else {}
+#endif
+            }
+        }
+        if (ProcessFlag == 1) { // Process the completed buffer, the sampler is filling the other one
+            readyData = &SampleData[ReadyBuffer];
             if (RECORD == 1) {
                 LEDGREEN_TURN_ON();         // Indicate recording is finished
                 if(GpioSWInput() == 3) {    // Check that user approves trick recording
-                    PrintAccelBuffers(&SampleData);    // Print speed does not matter
+#if TELEMETRY_BINARY_EN
+                    TelemetrySendCapture(readyData->samplesX, readyData->samplesY, readyData->samplesZ, SAMPLES_PER_BLOCK, SAMPLE_RATE_HZ);
+#else
+                    PrintAccelBuffers(readyData);    // Print speed does not matter
+#endif
                 } else {}       // User rejected recording, do nothing
                 LEDGREEN_TURN_OFF();
             }
             else { // Not recording new trick, process last accel. data
-                AccelDataAbsoluteValues(&SampleData);
-                currentScore = CalculateScore(&SampleData);
-                NormalizeAccelData(&SampleData);
-                //PrintAccelBuffers(&SampleData);
-                INT32U trick_id = TrickIdentify(&SampleData);
-                if (trick_id == 1) {
-                    backNForthCount += 1;
-                    BIOPutStrg("BackNForth");
+                AccelDataAbsoluteValues(readyData);
+                currentScore = CalculateScore(readyData);
+#if !MATCH_INCREMENTAL_EN
+                NormalizeAccelData(readyData);      // Incremental sums were taken on the raw samples
+#endif
+                //PrintAccelBuffers(readyData);
+#if MATCH_EARLY_EN
+                if (EarlyDecided == 0) {
+                    trickId = TrickIdentify(readyData, &trickMatch);
+                    PrintTrick(trickId, &trickMatch);
                     BIOOutCRLF();
-                    BIOPutStrg("Total: ");
-                    BIOOutDecByte(backNForthCount, 0);
-                } else if (trick_id == 2) {
-                    barrelRollCount += 1;
-                    BIOPutStrg("Barrel Roll");
+                } else {}
+                EarlyDecided = 0;
+#else
+                trickId = TrickIdentify(readyData, &trickMatch);
+                PrintTrick(trickId, &trickMatch);
+                BIOOutCRLF();
+#endif
+                if (trickId == 0) {
+                    TRIGGER_RELEARN();      // Maybe a lasting change, not a trick
+                } else {}
+                trickId = 0;
+                BIOOutDecWord(currentScore, 1);
+                BIOOutCRLF();
+#if NULL_GATE_EN
+                if (AbortedCaptures != 0) {
+                    BIOPutStrg("Captures: ");
+                    BIOOutDecWord(CompletedCaptures, 1);
+                    BIOPutStrg(" Aborted: ");
+                    BIOOutDecWord(AbortedCaptures, 1);
                     BIOOutCRLF();
-                    BIOPutStrg("Total: ");
-                    BIOOutDecByte(barrelRollCount, 0);
-                } else if (trick_id == 3) {
-                    spin180Count += 1;
-                    BIOPutStrg("Spin 180");
+                } else {}
+#endif
+                AccelSamplerStats(&samplerStats);
+                if ((samplerStats.queueOverruns != 0) || (samplerStats.deadlineMisses != 0) || (samplerStats.fifoOverflows != 0) || (samplerStats.sampleOverwrites != 0) || (samplerStats.readAborts != 0)) {
+                    BIOPutStrg("Overruns: ");
+                    BIOOutDecWord(samplerStats.queueOverruns, 1);
+                    BIOWrite(' ');
+                    BIOOutDecWord(samplerStats.deadlineMisses, 1);
+                    BIOWrite(' ');
+                    BIOOutDecWord(samplerStats.fifoOverflows, 1);
+                    BIOWrite(' ');
+                    BIOOutDecWord(samplerStats.sampleOverwrites, 1);
+                    BIOWrite(' ');
+                    BIOOutDecWord(samplerStats.readAborts, 1);
                     BIOOutCRLF();
-                    BIOPutStrg("Total: ");
-                    BIOOutDecByte(spin180Count, 0);
-                } else {
-                    BIOPutStrg("Not recognized");
                 }
+#if TELEMETRY_STREAM_EN
+                TelemetryStreamStats(&streamStats);
+                if (streamStats.sentBytes != 0) {
+                    streamRatio = (INT32U)(((INT64U)streamStats.rawBytes * 100U) / streamStats.sentBytes);
+                    BIOPutStrg("Stream ratio: ");
+                    BIOOutDecWord(streamRatio / 100U, 1);
+                    BIOWrite('.');
+                    BIOOutDecWord(streamRatio % 100U, 2);
+                    BIOOutCRLF();
+                } else {}
+#endif
+#if BIO_TX_BUFFERED_EN
+                BIOTxStats(&txStats);
+                if (txStats.highWater == (BIO_TX_BUF_SIZE - 1U)) {    // The buffer filled, output blocked or was dropped
+                    BIOPutStrg("TX full: ");
+                    BIOOutDecWord(txStats.dropped, 1);
+                    BIOOutCRLF();
+                } else {}
+#endif
+#if POWER_MGMT_EN
+                PowerStats(powerMs);
+                BIOPutStrg("Power mS: ");
+                BIOOutDecWord(powerMs[POWER_STATE_RUN], 1);
+                BIOWrite(' ');
+                BIOOutDecWord(powerMs[POWER_STATE_WAIT], 1);
+                BIOWrite(' ');
+                BIOOutDecWord(powerMs[POWER_STATE_STOP], 1);
                 BIOOutCRLF();
-                BIOOutDecWord(currentScore, 1);
-                BIOOutCRLF();
+#endif
                 BIOOutCRLF();
             }
-            /* Reset for regular sampling operation */
-            ProcessFlag = 0;
+            /* Release buffer back to the sampler */
             RECORD = 0;
-            RecordAccel = 0;
-            PIT->CHANNEL[0].TCTRL = PIT_TCTRL_TEN(1); // Re-enable PIT Timer
-            PIT->CHANNEL[0].TFLG = PIT_TFLG_TIF(1);
+            ProcessFlag = 0;
         }
-        else { // If not recording/processing, monitor for significant movement and record it
-            PITPend();
-            AccelSampleTask(&CurrAccelSample);
-
-            if (AccelTriggered(&CurrAccelSample) && !RecordAccel) { // If significant movement is detected, begin recording the next second of movement
-                RecordAccel = 1;
-                LEDBLUE_TURN_OFF();
-                LEDRED_TURN_ON();
-            }
-
-            if (RecordAccel == 1) {
-                FillAccelBuffers(&CurrAccelSample, &SampleData, &bufferIndex);
-            }
+#if CLOCK_SCALING_EN
+        /* Not switched while the BasicIO port is still sending, retried next pass */
+        if ((RecordAccel == 0) && (ProcessFlag == 0)) {
+            (void)ClkSetProfile(CLK_PROFILE_VLPR);  // Waiting for a trigger
+        } else {
+            (void)ClkSetProfile(CLK_PROFILE_BOOT);  // Recording or identifying
         }
+#endif
+#if POWER_MGMT_EN
+        if (ProcessFlag == 0) {     // Nothing to do before the next interrupt
+#if SAMPLER_HW_TRIGGER_EN
+            if ((RecordAccel == 0) && (AccelSamplerArm() != 0)) {
+                PowerStop();        // No sampling until the next transient
+            } else {
+                PowerWait();
+            }
+#else
+            PowerWait();
+#endif
+        } else {}
+#elif SAMPLER_HW_TRIGGER_EN
+        if ((RecordAccel == 0) && (ProcessFlag == 0) && (AccelSamplerArm() != 0)) {
+            __WFI();        // No sampling until the next transient, sleep until it
+        } else {}
+#endif
     }
 }
 
-/****************************************************************************************
-* LoadDBBuffer - Loads the X,Y,Z data from desired database trick into the given buffer structure
-****************************************************************************************/
-static void LoadDBBuffer(ACCEL_BUFFERS* buffer, INT8U trickIndex) {
-    arm_copy_q15((q15_t *)TRICK_DB[trickIndex][0], buffer->samplesX, SAMPLES_PER_BLOCK);
-    arm_copy_q15((q15_t *)TRICK_DB[trickIndex][1], buffer->samplesY, SAMPLES_PER_BLOCK);
-    arm_copy_q15((q15_t *)TRICK_DB[trickIndex][2], buffer->samplesZ, SAMPLES_PER_BLOCK);
-    AccelDataAbsoluteValues(buffer);
-    NormalizeAccelData(buffer);
-}
-
+#if !MATCH_INCREMENTAL_EN
 /****************************************************************************************
 * Log2 - Returns log base 2 of the provided number
 ****************************************************************************************/
@@ -186,7 +455,48 @@ static void NormalizeAccelData(ACCEL_BUFFERS* buffer) {
     arm_scale_q15(buffer->samplesY, y_frac, shift_y, buffer->samplesY, SAMPLES_PER_BLOCK);
     arm_scale_q15(buffer->samplesZ, z_frac, shift_z, buffer->samplesZ, SAMPLES_PER_BLOCK);
 }
+#endif
+
+/****************************************************************************************
+* PrintTrick - Counts and prints an identified trick with the offset it matched at and
+*              how many samples the decision took
+****************************************************************************************/
+static void PrintTrick(INT32U trick_id, const TRICK_MATCH* match) {
+    if (trick_id == 1) {
+        BackNForthCount += 1;
+        BIOPutStrg("BackNForth");
+        BIOOutCRLF();
+        BIOPutStrg("Total: ");
+        BIOOutDecByte(BackNForthCount, 0);
+    } else if (trick_id == 2) {
+        BarrelRollCount += 1;
+        BIOPutStrg("Barrel Roll");
+        BIOOutCRLF();
+        BIOPutStrg("Total: ");
+        BIOOutDecByte(BarrelRollCount, 0);
+    } else if (trick_id == 3) {
+        Spin180Count += 1;
+        BIOPutStrg("Spin 180");
+        BIOOutCRLF();
+        BIOPutStrg("Total: ");
+        BIOOutDecByte(Spin180Count, 0);
+    } else {
+        BIOPutStrg("Not recognized");
+    }
+    if (trick_id != 0) {
+        BIOPutStrg(" Lag: ");
+        if (match->lag < 0) {
+            BIOWrite('-');
+            BIOOutDecWord((INT32U)(-match->lag), 1);
+        } else {
+            BIOOutDecWord((INT32U)match->lag, 1);
+        }
+        BIOPutStrg(" Samples: ");
+        BIOOutDecWord(match->samples, 1);
+    } else {}
+}
 
+#if !TELEMETRY_BINARY_EN
 /****************************************************************************************
 * PrintAccelBuffers - Transfer the entirety of each buffer over BIOOut
 ****************************************************************************************/
@@ -221,7 +531,55 @@ static void PrintAccelBuffers(ACCEL_BUFFERS* buffer) {
     }
     BIOOutCRLF();
 }
+#endif
 
+#if SAMPLER_HW_TRIGGER_EN
+/* The FXOS transient detector triggers, see AccelSamplerTriggered() */
+#elif TRIGGER_ADAPTIVE_EN
+/****************************************************************************************
+* AccelTriggered - Signal to the event loop that enough movement has occurred to begin
+*                  recording to the buffers. Call for each sample while not recording,
+*                  samples that do not trigger update each axis' baseline:
+*                  mean += (x - mean) / 128, var += ((x - mean)^2 - var) / 128.
+****************************************************************************************/
+static INT8U AccelTriggered(ACCEL_DATA_3D* AccelData3D) {
+    INT16S sample[3] = {AccelData3D->x, AccelData3D->y, AccelData3D->z};
+    INT32S dev[3];
+    INT32S limit;
+    INT8U triggerStatus = 0;
+
+    if (TriggerWarmup == TRIGGER_WARMUP) {     // Start from the board's resting position
+        for (INT8U axis = 0; axis < 3; axis++) {
+            TriggerMean[axis] = (INT32S)sample[axis] << TRIGGER_MEAN_FRAC;
+            TriggerVar[axis] = 0;
+        }
+    } else {}
+    for (INT8U axis = 0; axis < 3; axis++) {
+        dev[axis] = sample[axis] - (TriggerMean[axis] >> TRIGGER_MEAN_FRAC);
+        if (dev[axis] > (INT32S)Q_MAX) {        // Keeps dev^2 within 32 bits
+            dev[axis] = Q_MAX;
+        } else if (dev[axis] < -(INT32S)Q_MAX) {
+            dev[axis] = -(INT32S)Q_MAX;
+        } else {}
+        limit = (TriggerVar[axis] > (TRIGGER_MIN_STD * TRIGGER_MIN_STD)) ? TriggerVar[axis] :
+                (TRIGGER_MIN_STD * TRIGGER_MIN_STD);
+        if ((TriggerWarmup == 0) && ((dev[axis] * dev[axis]) / (TRIGGER_K * TRIGGER_K) > limit)) {
+            triggerStatus = 1;
+        } else {}
+    }
+    if (triggerStatus == 0) {       // Movement is kept out of the baseline
+        for (INT8U axis = 0; axis < 3; axis++) {
+            TriggerMean[axis] += ((INT32S)sample[axis] * (1 << TRIGGER_MEAN_FRAC) - TriggerMean[axis]) >>
+                                 TRIGGER_EWMA_SHIFT;
+            TriggerVar[axis] += ((dev[axis] * dev[axis]) - TriggerVar[axis]) >> TRIGGER_EWMA_SHIFT;
+        }
+        if (TriggerWarmup != 0) {
+            TriggerWarmup--;
+        } else {}
+    } else {}
+    return triggerStatus;
+}
+#else
 /****************************************************************************************
 * AccelTriggered - Signal to the event loop that enough movement has occurred to begin
 *                  recording to the buffers
@@ -235,169 +593,98 @@ static INT8U AccelTriggered(ACCEL_DATA_3D* AccelData3D) {
     }
     return triggerStatus;
 }
+#endif
 
 /****************************************************************************************
 * FillAccelBuffers -    Transfers current acceleration sample to the buffers
-*                       of x, y, z samples of current 1 second interval.
+*                       of x, y, z samples of current 2 second interval.
+*                       When full, hands the buffer to the event loop and swaps to the
+*                       other buffer. The event loop processes it before the next capture
+*                       can fill, a capture is longer than SAMPLE_QUEUE_SIZE, so samples
+*                       that come in meanwhile wait in the sampler queue. Falling behind
+*                       shows as queueOverruns in AccelSamplerStats().
 ****************************************************************************************/
 static void FillAccelBuffers(ACCEL_DATA_3D* AccelData3D, ACCEL_BUFFERS* buffer, INT16U* bufferIndexPtr) {
     INT16U bufferIndex = *bufferIndexPtr;
+#if MATCH_INCREMENTAL_EN
+    TrickMatchAccumulate(AccelData3D, bufferIndex);
+#endif
     buffer->samplesX[bufferIndex] = AccelData3D->x;
     buffer->samplesY[bufferIndex] = AccelData3D->y;
     buffer->samplesZ[bufferIndex] = AccelData3D->z;
     bufferIndex++;
     if (bufferIndex == SAMPLES_PER_BLOCK) { // When buffers are filled, end recording and begin processing
         LEDRED_TURN_OFF();
-        PIT->CHANNEL[0].TCTRL &= ~PIT_TCTRL_TEN_MASK; // Disable PIT Timer
+        CompletedCaptures++;
+        ReadyBuffer = FillBuffer;
+        FillBuffer ^= 1U;
         ProcessFlag = 1;
+        RecordAccel = 0;            // Re-arm trigger for the next trick
         bufferIndex = 0;
     }
     *bufferIndexPtr = bufferIndex;
 }
 
+#if PRE_TRIGGER_SAMPLES > 0
 /****************************************************************************************
-* CalculateScore -  Calculates a simple "movement" score,
-*                   more acceleration movement yields a higher score
-****************************************************************************************/
-static INT16U CalculateScore(ACCEL_BUFFERS* buffer) {
-    /* Since the score is a sum of acceleration values for the last second,
-           we must use only positive values. */
-    INT32U score = 0;
-    for (INT16U i = 0; i < SAMPLES_PER_BLOCK; i++) {
-        score += (INT32U)buffer->absX[i];
-        score += (INT32U)buffer->absY[i];
-        score += (INT32U)buffer->absZ[i];
-    }
-    return (INT16U)(score/8000);
-}
-
-/****************************************************************************************
-* PitPend - Blocking function, exits when PIT has reached 0 in current cycle
+* PreTriggerStitch - Starts a capture with the PRE_TRIGGER_SAMPLES that came before the
+*                    trigger sample, oldest first, read from the history ring by index
 ****************************************************************************************/
-static void PITPend() {
-    INT32U timingCounter =  0;
-    while((PIT->CHANNEL[0].TFLG & (PIT_TFLG_TIF_MASK)) == 0) { // Wait for PIT to fire
-        timingCounter++;
-    }
+static void PreTriggerStitch(ACCEL_BUFFERS* buffer, INT16U* bufferIndexPtr) {
+    INT16U tail = PreTriggerHead - PRE_TRIGGER_SAMPLES;
 
-    PIT->CHANNEL[0].TFLG = PIT_TFLG_TIF(1);
-    if (timingCounter == 0) {
-        while(1) {} // If in this trap, we failed timing
+    for (INT16U i = 0; i < PRE_TRIGGER_SAMPLES; i++) {
+        FillAccelBuffers(&PreTrigger[(tail + i) & PRE_TRIGGER_MASK], buffer, bufferIndexPtr);
     }
 }
+#endif
 
+#if NULL_GATE_EN
 /****************************************************************************************
-* TrickIdentify - Identifies the most likely trick match between last recorded movement
-*                 and the trick database
+* NullGateReject - Streams the start of a capture through the null-class gate. Call after
+*                  each sample is stored, count being the samples stored since the trigger.
+*   return: 1 once NULL_GATE_SAMPLES are in and they moved too little to be a trick
 ****************************************************************************************/
-static INT32U TrickIdentify(ACCEL_BUFFERS* buffer) {
-    INT32S corrCoeffX, corrCoeffY, corrCoeffZ;
-    INT32S corr_means[NUM_DB_TRICKS];
-    INT64S current_mean;
-    ACCEL_BUFFERS db_buffer;
-
-    for (INT8U i = 0; i < NUM_DB_TRICKS; i++) {
-        current_mean = 0;
-        LoadDBBuffer(&db_buffer, i);
-        corrCoeffX = CorrelCoeff(buffer->samplesX, db_buffer.samplesX);
-        corrCoeffY = CorrelCoeff(buffer->samplesY, db_buffer.samplesY);
-        corrCoeffZ = CorrelCoeff(buffer->samplesZ, db_buffer.samplesZ);
-
-        current_mean += corrCoeffX;
-        current_mean += corrCoeffY;
-        current_mean += corrCoeffZ;
-        corr_means[i] = (INT32S)(current_mean/3);
-    }
+static INT8U NullGateReject(ACCEL_DATA_3D* AccelData3D, INT16U count) {
+    INT16S sample[3] = {AccelData3D->x, AccelData3D->y, AccelData3D->z};
+    INT64S variance = 0;
 
-    q31_t max_val;
-    INT32U max_index;
-    arm_max_q31(corr_means, NUM_DB_TRICKS, &max_val, &max_index);
-    if (max_val > (1 << 28)) {
-        return max_index + 1;
-    } else {
+    if (count > NULL_GATE_SAMPLES) {
         return 0;
+    } else {}
+    for (INT8U axis = 0; axis < 3; axis++) {
+        if (count == 1) {
+            GateSum[axis] = 0;
+            GateSos[axis] = 0;
+        } else {}
+        GateSum[axis] += sample[axis];
+        GateSos[axis] += (INT32S)sample[axis] * sample[axis];
     }
-}
-
-/****************************************************************************************
-* SquareRoot -  Shamelessly copied from stack overflow, after arm_sqrt did not work
-*            -  modified slightly for int64u input
-* https://stackoverflow.com/questions/1100090/looking-for-an-efficient-integer-square-root-algorithm-for-arm-thumb2
-****************************************************************************************/
-static INT64U SquareRoot(INT64U a_nInput)
-{
-    INT64U op  = a_nInput;
-    INT64U res = 0;
-    INT64U one = 1ULL << 62; // The second-to-top bit is set: use 1u << 14 for uint16_t type; use 1uL<<30 for uint32_t type
-
-    // "one" starts at the highest power of four <= than the argument.
-    while (one > op) {
-        one >>= 2;
-    }
-
-    while (one != 0) {
-        if (op >= res + one) {
-            op = op - (res + one);
-            res = res +  2 * one;
-        }
-        res >>= 1;
-        one >>= 2;
+    if (count < NULL_GATE_SAMPLES) {
+        return 0;
+    } else {}
+    for (INT8U axis = 0; axis < 3; axis++) {
+        variance += (GateSos[axis] * NULL_GATE_SAMPLES) - ((INT64S)GateSum[axis] * GateSum[axis]);
     }
-    return res;
+    variance /= (INT64S)NULL_GATE_SAMPLES * NULL_GATE_SAMPLES;
+    return (variance < ((INT64S)NULL_GATE_MIN_STD * NULL_GATE_MIN_STD)) ? 1U : 0U;
 }
+#endif
 
 /****************************************************************************************
-* CorrelCoeff - Support function for TrickIdentify, correlates the correlation coefficient
-*               between the two data sets given
+* CalculateScore -  Calculates a simple "movement" score,
+*                   more acceleration movement yields a higher score
 ****************************************************************************************/
-static INT32S CorrelCoeff(INT16S* curr_data_buffer, INT16S* db_buffer) {
-    int16_t mean_db, mean_curr;
-
-    int32_t adj_db[SAMPLES_PER_BLOCK];
-    int32_t adj_curr[SAMPLES_PER_BLOCK];
-
-    int32_t product_db_curr[SAMPLES_PER_BLOCK];
-
-    arm_mean_q15(db_buffer, SAMPLES_PER_BLOCK, &mean_db);
-    arm_mean_q15(curr_data_buffer, SAMPLES_PER_BLOCK, &mean_curr);
-
-    for (INT16U i = 0; i < SAMPLES_PER_BLOCK; i++) {
-        adj_db[i] = (int32_t)((int32_t)db_buffer[i] - (int32_t)mean_db);
-
-        adj_curr[i] = (int32_t)((int32_t)curr_data_buffer[i] - (int32_t)mean_curr);
-    }
-
-    //arm_mult_q31(adj_db, adj_curr, product_db_curr, SAMPLES_PER_BLOCK);
-    for (INT16U i = 0; i < SAMPLES_PER_BLOCK; i++) {
-        product_db_curr[i] = adj_db[i] * adj_curr[i];
-    }
-
-    int64_t sum = 0;
-    for (INT16U i = 0; i < SAMPLES_PER_BLOCK; i++) {
-        sum += product_db_curr[i];
-    }
-    int32_t numerator = (int32_t)(sum >> 15);
-
-    int64_t sos_db, sos_curr;
-    for (INT16U i = 0; i < SAMPLES_PER_BLOCK; i++) {
-        adj_db[i] = adj_db[i] * adj_db[i];
-        adj_curr[i] = adj_curr[i] * adj_curr[i];
-    }
-    sos_db = 0;
-    sos_curr = 0;
+static INT16U CalculateScore(ACCEL_BUFFERS* buffer) {
+    /* Since the score is a sum of acceleration values for the last second,
+           we must use only positive values. */
+    INT32U score = 0;
     for (INT16U i = 0; i < SAMPLES_PER_BLOCK; i++) {
-        sos_db += adj_db[i];
-        sos_curr += adj_curr[i];
+        score += (INT32U)buffer->absX[i];
+        score += (INT32U)buffer->absY[i];
+        score += (INT32U)buffer->absZ[i];
     }
-
-    int32_t sos_db_scaled = (int32_t)(sos_db >> 15);
-    int32_t sos_curr_scaled = (int32_t)(sos_curr >> 15);
-    uint64_t bottom_product = (uint64_t) sos_db_scaled * sos_curr_scaled;
-
-    int32_t denominator;
-    denominator = (int32_t)SquareRoot(bottom_product);
-
-    return (int32_t)(((int64_t)numerator * (1UL << 31)) / denominator);
+    return (INT16U)(score/8000);
 }
 
 /****************************************************************************************
@@ -409,14 +696,4 @@ static void AccelDataAbsoluteValues(ACCEL_BUFFERS* buffer) {
     arm_abs_q15(buffer->samplesZ, buffer->absZ, SAMPLES_PER_BLOCK);
 }
 
-/****************************************************************************************
-* PITInit - Configure PIT to trigger every 1.25mS, the sample period of the accelerometer
-****************************************************************************************/
-static void PITInit() {
-    SIM->SCGC6 |= SIM_SCGC6_PIT(1);  // Enable PIT module
-    PIT->MCR = PIT_MCR_MDIS(0);     // Enable clock for standard PIT timers
-    PIT->CHANNEL[0].LDVAL = LDVAL_800HZ;
-    PIT->CHANNEL[0].TCTRL = PIT_TCTRL_TEN(1); // Enable PIT Timer
-}
-
 /********************************************************************************/
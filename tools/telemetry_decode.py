@@ -0,0 +1,242 @@
+#!/usr/bin/env python3
+"""Decode the binary telemetry frames sent by source/Telemetry.c.
+
+Reads a serial port (needs pyserial) or a file of captured bytes, checks each frame's
+CRC, reassembles the captures and writes them as CSV, or as C arrays laid out like
+TRICK_DB in source/TrickDB.h. Text printed between frames is skipped, or passed to
+stderr with --text.
+
+Live stream frames (TELEMETRY_STREAM_EN) are written as CSV lines to --stream, with the
+compression ratio achieved reported on stderr.
+
+    telemetry_decode.py /dev/ttyACM0 --baud 115200 --format c
+    telemetry_decode.py dump.bin --out capture
+    telemetry_decode.py /dev/ttyACM0 --stream live.csv
+
+--db-crc prints the TRICK_DB_CRC of a TrickDB.h whose arrays were edited.
+
+    telemetry_decode.py --db-crc source/TrickDB.h
+"""
+import argparse
+import re
+import struct
+import sys
+
+SYNC = b"\xa5\x5a"
+TYPE_CAPTURE = 0x01
+TYPE_STREAM = 0x02
+HEADER = struct.Struct("<BBHBBHH")      # type seq rate axes count offset total
+AXIS_NAMES = "XYZ"
+
+
+def crc16_ccitt_false(data, crc=0xFFFF):
+    for byte in data:
+        crc ^= byte << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else (crc << 1)
+            crc &= 0xFFFF
+    return crc
+
+
+class Decoder:
+    """Byte-stream frame parser. feed() returns the captures completed so far."""
+
+    def __init__(self, text=None, stream=None):
+        self.buf = bytearray()
+        self.text = text
+        self.stream = stream
+        self.stream_next = None
+        self.stream_raw = 0
+        self.stream_sent = 0
+        self.capture = None
+        self.next_seq = None
+        self.crc_errors = 0
+        self.seq_gaps = 0
+
+    def feed(self, data):
+        self.buf += data
+        done = []
+        while True:
+            start = self.buf.find(SYNC)
+            if start < 0:
+                keep = 1 if self.buf[-1:] == SYNC[:1] else 0
+                self._skip(len(self.buf) - keep)
+                break
+            self._skip(start)
+            if len(self.buf) < 2 + HEADER.size:
+                break
+            ftype, seq, rate, axes, count, offset, total = HEADER.unpack_from(self.buf, 2)
+            if ftype == TYPE_CAPTURE and offset + count <= total:
+                payload = 2 * axes * count
+            elif ftype == TYPE_STREAM and 2 * axes <= total <= 6 * axes * count:
+                payload = total
+            else:
+                payload = None
+            if payload is None or axes == 0 or count == 0:
+                self._skip(1)           # Sync bytes inside text or payload
+                continue
+            length = 2 + HEADER.size + payload + 2
+            if len(self.buf) < length:
+                break
+            body = bytes(self.buf[2:length - 2])
+            (crc,) = struct.unpack_from("<H", self.buf, length - 2)
+            if crc16_ccitt_false(body) != crc:
+                self.crc_errors += 1
+                self._skip(1)
+                continue
+            del self.buf[:length]
+            if ftype == TYPE_STREAM:
+                self._stream(seq, axes, count, offset, body[HEADER.size:], length)
+                continue
+            capture = self._frame(seq, rate, axes, count, offset, total, body[HEADER.size:])
+            if capture is not None:
+                done.append(capture)
+        return done
+
+    def _skip(self, n):
+        if n > 0:
+            if self.text is not None:
+                self.text.write(self.buf[:n].decode("ascii", "replace"))
+            del self.buf[:n]
+
+    def _sequence(self, seq):
+        if self.next_seq is not None and seq != self.next_seq:
+            self.seq_gaps += 1
+        self.next_seq = (seq + 1) & 0xFF
+
+    def _stream(self, seq, axes, count, index, payload, length):
+        """Undo the zigzag varint differences of a TYPE_STREAM frame."""
+        self._sequence(seq)
+        if self.stream_next is not None and index != self.stream_next:
+            sys.stderr.write("stream gap: %d samples\n" % ((index - self.stream_next) & 0xFFFF))
+        self.stream_next = (index + count) & 0xFFFF
+        self.stream_raw += 2 * axes * count
+        self.stream_sent += length
+        sample = list(struct.unpack_from("<%dh" % axes, payload))
+        samples = [tuple(sample)]
+        pos = 2 * axes
+        for _ in range(count - 1):
+            for axis in range(axes):
+                value, shift = 0, 0
+                while True:
+                    byte = payload[pos]
+                    pos += 1
+                    value |= (byte & 0x7F) << shift
+                    shift += 7
+                    if not byte & 0x80:
+                        break
+                sample[axis] += (value >> 1) ^ -(value & 1)
+            samples.append(tuple(sample))
+        if self.stream is not None:
+            for i, s in enumerate(samples):
+                self.stream.write("%d,%s\n" % ((index + i) & 0xFFFF, ",".join(str(v) for v in s)))
+            self.stream.flush()
+
+    def _frame(self, seq, rate, axes, count, offset, total, payload):
+        self._sequence(seq)
+        if offset == 0:
+            self.capture = {"rate": rate, "axes": axes, "total": total,
+                            "samples": [None] * total}
+        cap = self.capture
+        if cap is None or cap["axes"] != axes or cap["total"] != total:
+            return None         # Joined part way through a capture
+        values = struct.unpack("<%dh" % (axes * count), payload)
+        for i in range(count):
+            cap["samples"][offset + i] = values[i * axes:(i + 1) * axes]
+        if offset + count == total:
+            self.capture = None
+            missing = cap["samples"].count(None)
+            if missing:
+                sys.stderr.write("capture dropped, %d samples missing\n" % missing)
+                return None
+            return cap
+        return None
+
+
+def write_csv(cap, out):
+    out.write(",".join(AXIS_NAMES[:cap["axes"]]) + "\n")
+    for sample in cap["samples"]:
+        out.write(",".join(str(v) for v in sample) + "\n")
+
+
+def write_c(cap, out, per_line=40):
+    for axis in range(cap["axes"]):
+        out.write("{ // %s\n" % AXIS_NAMES[axis])
+        values = ["0x%04X" % (s[axis] & 0xFFFF) for s in cap["samples"]]
+        for i in range(0, len(values), per_line):
+            out.write("\t" + ", ".join(values[i:i + per_line]) + ",\n")
+        out.write("},\n")
+
+
+def db_crc(path):
+    """CRC of the TRICK_DB initializer as the K22 stores it, little-endian INT16S."""
+    text = open(path).read()
+    start = text.index("TRICK_DB[")
+    body = text[text.index("{", start):text.index("};", start)]
+    values = [int(v, 16) for v in re.findall(r"0x([0-9A-Fa-f]+)", body)]
+    return crc16_ccitt_false(struct.pack("<%dH" % len(values), *values))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("source", nargs="?", help="serial port or file of captured bytes")
+    parser.add_argument("--baud", type=int, default=115200)
+    parser.add_argument("--format", choices=("csv", "c"), default="csv")
+    parser.add_argument("--out", help="write capture N to OUT_N.csv/.c instead of stdout")
+    parser.add_argument("--count", type=int, default=0, help="stop after COUNT captures")
+    parser.add_argument("--text", action="store_true", help="copy text between frames to stderr")
+    parser.add_argument("--stream", help="write live stream samples to this CSV file, - for stdout")
+    parser.add_argument("--db-crc", metavar="TRICKDB_H", help="print the TRICK_DB_CRC of this file and exit")
+    args = parser.parse_args()
+
+    if args.db_crc:
+        print("#define TRICK_DB_CRC 0x%04XU" % db_crc(args.db_crc))
+        return 0
+    if args.source is None:
+        parser.error("source is required")
+
+    try:
+        import serial
+        port = serial.Serial(args.source, args.baud, timeout=1)
+        read = lambda: port.read(4096)
+        live = True
+    except (ImportError, ValueError, OSError):
+        stream = open(args.source, "rb")
+        read = lambda: stream.read(4096)
+        live = False
+
+    stream_out = None
+    if args.stream:
+        stream_out = sys.stdout if args.stream == "-" else open(args.stream, "w")
+    decoder = Decoder(sys.stderr if args.text else None, stream_out)
+    writer = write_c if args.format == "c" else write_csv
+    captures = 0
+    try:
+        while True:
+            data = read()
+            if not data and not live:
+                break
+            for cap in decoder.feed(data):
+                if args.out:
+                    name = "%s_%d.%s" % (args.out, captures, args.format)
+                    with open(name, "w") as out:
+                        writer(cap, out)
+                    sys.stderr.write("%s: %d samples at %d Hz\n" % (name, cap["total"], cap["rate"]))
+                else:
+                    writer(cap, sys.stdout)
+                captures += 1
+                if args.count and captures >= args.count:
+                    return 0
+    except KeyboardInterrupt:
+        pass
+    finally:
+        if decoder.stream_sent:
+            sys.stderr.write("stream: %d bytes as %d sent, ratio %.2f\n" % (
+                decoder.stream_raw, decoder.stream_sent, decoder.stream_raw / decoder.stream_sent))
+        if decoder.crc_errors or decoder.seq_gaps:
+            sys.stderr.write("CRC errors: %d, sequence gaps: %d\n" % (decoder.crc_errors, decoder.seq_gaps))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
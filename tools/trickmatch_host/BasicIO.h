@@ -0,0 +1,18 @@
+/**********************************************************************************
+* BasicIO.h - Host stand-in for board/BasicIO.h, the calls TrickMatch.c makes when
+*             TRICK_BENCH_EN is set, sent to stdout
+**********************************************************************************/
+#ifndef BIO_INCL
+#define BIO_INCL
+#include <stdio.h>
+static inline void BIOPutStrg(const INT8C* strg) {
+    fputs(strg, stdout);
+}
+static inline void BIOOutDecWord(INT32U binin, INT8U field) {
+    (void)field;
+    printf("%u", (unsigned)binin);
+}
+static inline void BIOOutCRLF(void) {
+    putchar('\n');
+}
+#endif
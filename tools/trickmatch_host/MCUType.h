@@ -0,0 +1,191 @@
+/**********************************************************************************
+* MCUType.h - Host stand-in for source/MCUType.h, used by trickmatch_host.c only.
+*             The WWU types at their target widths, and portable versions of the
+*             CMSIS intrinsics and CMSIS-DSP functions that TrickMatch.c calls.
+*             __ARM_FEATURE_DSP is not defined on a host, so TrickMatch.c builds its
+*             portable MAC_PAIR fallback.
+**********************************************************************************/
+#ifndef  MCU_TYPE_PRESENT
+#define  MCU_TYPE_PRESENT
+
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+
+typedef char                INT8C;
+typedef unsigned char       INT8U;
+typedef signed char         INT8S;
+typedef unsigned short      INT16U;
+typedef signed short        INT16S;
+typedef uint32_t            INT32U;
+typedef int32_t             INT32S;
+typedef unsigned long long  INT64U;
+typedef signed long long    INT64S;
+typedef float               FP32;
+typedef double              FP64;
+
+typedef int16_t q15_t;
+typedef int32_t q31_t;
+typedef float float32_t;
+
+#define FALSE    0
+#define TRUE     1
+
+/**********************************************************************************
+* CMSIS core
+**********************************************************************************/
+#define __CLZ(x)                    ((uint8_t)__builtin_clz(x))
+static inline uint32_t __UNALIGNED_UINT32_READ(const void* p) {
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+/* TrickMatchBenchmark() is built with TRICK_BENCH_EN but only run on target */
+typedef struct {
+    uint32_t CTRL;
+    uint32_t CYCCNT;
+} HOST_DWT_Type;
+typedef struct {
+    uint32_t DEMCR;
+} HOST_CoreDebug_Type;
+static HOST_DWT_Type HostDwt;
+static HOST_CoreDebug_Type HostCoreDebug;
+#define DWT                             (&HostDwt)
+#define CoreDebug                       (&HostCoreDebug)
+#define DWT_CTRL_CYCCNTENA_Msk          1U
+#define CoreDebug_DEMCR_TRCENA_Msk      (1U << 24)
+
+/**********************************************************************************
+* CMSIS-DSP, plain C with the library's saturation
+**********************************************************************************/
+static inline q15_t HostSat15(int32_t v) {
+    return (q15_t)((v > 32767) ? 32767 : ((v < -32768) ? -32768 : v));
+}
+
+static inline void arm_max_q31(const q31_t* p, uint32_t n, q31_t* v, uint32_t* idx) {
+    *v = p[0];
+    *idx = 0;
+    for (uint32_t i = 1; i < n; i++) {
+        if (p[i] > *v) {
+            *v = p[i];
+            *idx = i;
+        }
+    }
+}
+
+static inline void arm_max_q15(const q15_t* p, uint32_t n, q15_t* v, uint32_t* idx) {
+    *v = p[0];
+    *idx = 0;
+    for (uint32_t i = 1; i < n; i++) {
+        if (p[i] > *v) {
+            *v = p[i];
+            *idx = i;
+        }
+    }
+}
+
+static inline void arm_abs_q15(const q15_t* s, q15_t* d, uint32_t n) {
+    for (uint32_t i = 0; i < n; i++) {
+        d[i] = (s[i] == -32768) ? 32767 : (q15_t)((s[i] < 0) ? -s[i] : s[i]);
+    }
+}
+
+static inline void arm_copy_q15(const q15_t* s, q15_t* d, uint32_t n) {
+    memcpy(d, s, n * sizeof(q15_t));
+}
+
+static inline void arm_mean_q15(const q15_t* s, uint32_t n, q15_t* m) {
+    int32_t sum = 0;
+    for (uint32_t i = 0; i < n; i++) {
+        sum += s[i];
+    }
+    *m = (q15_t)(sum / (int32_t)n);
+}
+
+static inline void arm_scale_q15(const q15_t* s, q15_t f, int8_t sh, q15_t* d, uint32_t n) {
+    for (uint32_t i = 0; i < n; i++) {
+        d[i] = HostSat15(((int32_t)s[i] * f) >> (15 - sh));
+    }
+}
+
+static inline int arm_sqrt_f32(float in, float* out) {
+    *out = (in >= 0.0f) ? sqrtf(in) : 0.0f;
+    return 0;
+}
+
+/* The real FFT as a direct DFT, in the arm_rfft_fast_f32 packing: bin 0 and bin N/2
+ * real parts first, then re, im of bins 1 to N/2-1. The inverse includes the 1/N. */
+typedef struct {
+    uint16_t fftLen;
+} arm_rfft_fast_instance_f32;
+
+static inline int arm_rfft_fast_init_f32(arm_rfft_fast_instance_f32* S, uint16_t n) {
+    S->fftLen = n;
+    return 0;
+}
+
+static inline void arm_rfft_fast_f32(const arm_rfft_fast_instance_f32* S, float* p, float* o,
+                                     uint8_t inverse) {
+    int n = S->fftLen;
+    for (int k = 0; (inverse == 0) && (k <= n / 2); k++) {
+        double re = 0.0;
+        double im = 0.0;
+        for (int t = 0; t < n; t++) {
+            double w = 2.0 * M_PI * (double)(((int64_t)k * t) % n) / n;
+            re += p[t] * cos(w);
+            im -= p[t] * sin(w);
+        }
+        if (k == 0) {
+            o[0] = (float)re;
+        } else if (k == n / 2) {
+            o[1] = (float)re;
+        } else {
+            o[2 * k] = (float)re;
+            o[2 * k + 1] = (float)im;
+        }
+    }
+    for (int t = 0; (inverse != 0) && (t < n); t++) {
+        double v = p[0] + ((t & 1) ? -p[1] : p[1]);
+        for (int k = 1; k < n / 2; k++) {
+            double w = 2.0 * M_PI * (double)(((int64_t)k * t) % n) / n;
+            v += 2.0 * (p[2 * k] * cos(w) - p[2 * k + 1] * sin(w));
+        }
+        o[t] = (float)(v / n);
+    }
+}
+
+typedef struct {
+    uint8_t M;
+    uint16_t numTaps;
+    const q15_t* pCoeffs;
+    q15_t* pState;
+} arm_fir_decimate_instance_q15;
+
+static inline int arm_fir_decimate_init_q15(arm_fir_decimate_instance_q15* S, uint16_t numTaps,
+                                            uint8_t M, const q15_t* pCoeffs, q15_t* pState,
+                                            uint32_t blockSize) {
+    S->M = M;
+    S->numTaps = numTaps;
+    S->pCoeffs = pCoeffs;
+    S->pState = pState;
+    memset(pState, 0, (numTaps + blockSize - 1U) * sizeof(q15_t));
+    return 0;
+}
+
+static inline void arm_fir_decimate_q15(const arm_fir_decimate_instance_q15* S, const q15_t* src,
+                                        q15_t* dst, uint32_t blockSize) {
+    int taps = S->numTaps;
+    q15_t* state = S->pState;
+    memcpy(&state[taps - 1], src, blockSize * sizeof(q15_t));
+    for (uint32_t o = 0; o < blockSize / S->M; o++) {
+        int64_t acc = 0;
+        for (int k = 0; k < taps; k++) {
+            acc += (int32_t)S->pCoeffs[k] * state[o * S->M + S->M - 1U + (uint32_t)(taps - 1 - k)];
+        }
+        dst[o] = HostSat15((int32_t)(acc >> 15));
+    }
+    memmove(state, &state[blockSize], (size_t)(taps - 1) * sizeof(q15_t));
+}
+
+#endif
@@ -0,0 +1,8 @@
+/**********************************************************************************
+* cr_section_macros.h - Host stand-in, RAM bank placement is a no-op
+**********************************************************************************/
+#ifndef CR_SECTION_MACROS_H
+#define CR_SECTION_MACROS_H
+#define __BSS(bank)
+#define __DATA(bank)
+#endif
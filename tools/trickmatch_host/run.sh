@@ -0,0 +1,38 @@
+#!/bin/sh
+# Builds tools/trickmatch_host/trickmatch_host.c against source/TrickMatch.c in each
+# configuration below and runs it. The host MCUType.h here replaces the target one, so
+# the portable MAC_PAIR fallback is what is checked. Needs gcc, or CC, and libm.
+#     tools/trickmatch_host/run.sh
+# Exit status is the number of configurations that failed.
+cd "$(dirname "$0")" || exit 1
+CC=${CC:-gcc}
+OUT=${TMPDIR:-/tmp}/trickmatch_host
+FAILED=0
+
+check() {
+    name=$1
+    shift
+    flags=$1
+    shift
+    echo "== $name"
+    # shellcheck disable=SC2086
+    if $CC -std=gnu99 -O2 -Wall -I. -I../../source -DCRC_HW_EN=0 -DTRICK_BENCH_EN=1 $flags \
+            -o "$OUT" trickmatch_host.c -lm && "$OUT" "$@"; then
+        :
+    else
+        FAILED=$((FAILED + 1))
+    fi
+}
+
+check "direct, coarse ranking" ""
+check "direct, every template at full rate" "-DMATCH_COARSE_TOP_K=0"
+check "direct, cascade" "-DMATCH_CASCADE_EN=1"
+check "direct, cascade, every template" "-DMATCH_CASCADE_EN=1 -DMATCH_COARSE_TOP_K=0"
+check "direct, incremental" "-DMATCH_INCREMENTAL_EN=1" 0 40 -30 75
+check "direct, incremental, early exit" "-DMATCH_INCREMENTAL_EN=1 -DMATCH_EARLY_EN=1" 0 40 -30 75 -80
+check "fft" "-DMATCH_ENGINE=MATCH_ENGINE_FFT"
+check "fft, +/-400 lags" "-DMATCH_ENGINE=MATCH_ENGINE_FFT -DMATCH_MAX_LAG=400" 300 -250
+check "dtw" "-DMATCH_ENGINE=MATCH_ENGINE_DTW" 0
+rm -f "$OUT"
+echo "$FAILED configuration(s) failed"
+exit $FAILED
@@ -0,0 +1,452 @@
+/****************************************************************************************
+ * DESCRIPTION: Host check of source/TrickMatch.c. TrickMatch.c is included whole, so its
+ *              static kernels can be called, with the host MCUType.h in this directory.
+ *              __ARM_FEATURE_DSP is not defined here, so the portable MAC_PAIR fallback is
+ *              what runs. Each TRICK_DB recording, halved and shifted by the given
+ *              sample counts, goes through the event loop's normalization and is matched
+ *              and compared with a double precision Pearson reference. With the cascade
+ *              on, the recordings are also attenuated and made noisy to check that
+ *              CascadePrune() keeps their own template and prunes the others. With early
+ *              exit on, each shifted recording must also be decided as itself by
+ *              TrickIdentifyEarly() before its window fills. Build and run through run.sh.
+ *                  trickmatch_host [shift ...]     default shifts: 0 40 -30
+ *              Exit status is the number of failed checks.
+ * AUTHOR: Neal Crawford
+ * HISTORY: Started 10/16/2026
+*****************************************************************************************
+* Master header file
+****************************************************************************************/
+#include "MCUType.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "TrickMatch.c"
+#include "Crc.c"
+
+#define CORREL_TOLERANCE 1e-3       // Q31 kernels against the double reference
+#define MATCH_TOLERANCE  2e-3       // Match scores: the FFT path rounds in float32
+#define ROOT_MANTISSA    4194304.0  // SquareRoot() keeps 24 bits of the root, allows 2 ulp
+#define BENCH_RUNS       20000
+#define BENCH_REPEATS    5          // Best of, host timing is noisy
+#define CASCADE_MIN_PRUNED 40U      // Percent of the other templates CascadePrune() must skip
+
+/* The reference needs the templates as TrickMatchInit() scales them */
+#define HOST_REF_EN (MATCH_ENGINE != MATCH_ENGINE_DTW)
+
+/****************************************************************************************
+* Function prototypes
+****************************************************************************************/
+static void CaptureShifted(INT8U trick, INT32S shift);
+static void CaptureNormalize(void);
+static INT32U Check(const char* what, INT8U pass);
+#if HOST_REF_EN
+static void RefTemplatesInit(void);
+static FP64 RefPearson(const FP64* x, const FP64* y, INT32S n);
+static FP64 RefLagCorrel(INT8U trick, INT32S lag);
+static INT32S RefBestLag(INT8U trick, FP64* corr);
+#endif
+#if HOST_REF_EN
+static INT32U CheckKernels(void);
+#endif
+#if MATCH_CORREL_EN
+static INT32U CheckSquareRoot(void);
+static FP64 Seconds(void);
+static void BenchKernels(void);
+#endif
+static INT32U CheckMatches(INT32S shift);
+#if MATCH_CASCADE_EN
+static INT32U CheckCascade(void);
+#endif
+#if MATCH_EARLY_EN
+static INT32U CheckEarly(INT32S shift);
+#endif
+
+/****************************************************************************************
+* Static file variables
+****************************************************************************************/
+static ACCEL_BUFFERS Capture;
+#if HOST_REF_EN
+static FP64 RefTemplate[NUM_DB_TRICKS][NUM_AXES][SAMPLES_PER_BLOCK];
+#endif
+
+int main(int argc, char** argv) {
+    static const INT32S defaultShifts[] = {0, 40, -30};
+    INT32U failed = 0;
+
+    printf("MATCH_ENGINE %d, MATCH_MAX_LAG %d, MATCH_COARSE_TOP_K %d, MATCH_INCREMENTAL_EN %d\n",
+           MATCH_ENGINE, MATCH_MAX_LAG, MATCH_COARSE_TOP_K, MATCH_INCREMENTAL_EN);
+    TrickMatchInit();
+#if HOST_REF_EN
+    RefTemplatesInit();
+#endif
+#if HOST_REF_EN
+    failed += CheckKernels();
+#endif
+#if MATCH_CORREL_EN
+    failed += CheckSquareRoot();
+    BenchKernels();
+#endif
+#if MATCH_CASCADE_EN
+    failed += CheckCascade();
+#endif
+    if (argc > 1) {
+        for (int i = 1; i < argc; i++) {
+            failed += CheckMatches(atoi(argv[i]));
+#if MATCH_EARLY_EN
+            failed += CheckEarly(atoi(argv[i]));
+#endif
+        }
+    } else {
+        for (INT8U i = 0; i < (sizeof(defaultShifts) / sizeof(defaultShifts[0])); i++) {
+            failed += CheckMatches(defaultShifts[i]);
+#if MATCH_EARLY_EN
+            failed += CheckEarly(defaultShifts[i]);
+#endif
+        }
+    }
+    printf("%s, %u failed\n", (failed == 0) ? "PASS" : "FAIL", (unsigned)failed);
+    return (int)failed;
+}
+
+/****************************************************************************************
+* CaptureShifted - TRICK_DB recording trick, halved and delayed by shift samples with the
+*                  ends held, as the capture. In incremental mode it is also fed to
+*                  TrickMatchAccumulate() one sample at a time, as FillAccelBuffers does.
+****************************************************************************************/
+static void CaptureShifted(INT8U trick, INT32S shift) {
+    INT32S j;
+    for (INT32S i = 0; i < SAMPLES_PER_BLOCK; i++) {
+        j = i - shift;
+        j = (j < 0) ? 0 : ((j >= SAMPLES_PER_BLOCK) ? (SAMPLES_PER_BLOCK - 1) : j);
+        Capture.samplesX[i] = (INT16S)(TRICK_DB[trick][0][j] / 2);
+        Capture.samplesY[i] = (INT16S)(TRICK_DB[trick][1][j] / 2);
+        Capture.samplesZ[i] = (INT16S)(TRICK_DB[trick][2][j] / 2);
+#if MATCH_INCREMENTAL_EN
+        ACCEL_DATA_3D sample = {Capture.samplesX[i], Capture.samplesY[i], Capture.samplesZ[i]};
+        TrickMatchAccumulate(&sample, (INT16U)i);
+#endif
+    }
+#if !MATCH_INCREMENTAL_EN
+    CaptureNormalize();
+#endif
+}
+
+/****************************************************************************************
+* CaptureNormalize - Each axis scaled to full Q15 range, as AccelDataAbsoluteValues() and
+*                    NormalizeAccelData() in TrickTrackMain.c do before TrickIdentify()
+****************************************************************************************/
+static void CaptureNormalize(void) {
+    INT16S* samples[NUM_AXES] = {Capture.samplesX, Capture.samplesY, Capture.samplesZ};
+    INT16S* abs[NUM_AXES] = {Capture.absX, Capture.absY, Capture.absZ};
+    INT16S max;
+    uint32_t index;
+    INT8U shift;
+    INT16U frac;
+    for (INT8U axis = 0; axis < NUM_AXES; axis++) {
+        arm_abs_q15(samples[axis], abs[axis], SAMPLES_PER_BLOCK);
+        arm_max_q15(abs[axis], SAMPLES_PER_BLOCK, &max, &index);
+        shift = 1;
+        for (INT16U x = (INT16U)(Q_MAX / max); x > 1U; x >>= 1) {
+            shift++;
+        }
+        frac = (INT16U)((((INT32U)Q_MAX << 15) / (INT32U)max) >> shift);
+        arm_scale_q15(samples[axis], (q15_t)frac, (int8_t)shift, samples[axis], SAMPLES_PER_BLOCK);
+    }
+}
+
+/****************************************************************************************
+* Check - Prints one result line
+*   return: 1 if it failed
+****************************************************************************************/
+static INT32U Check(const char* what, INT8U pass) {
+    printf("  %-4s %s\n", (pass != 0) ? "ok" : "FAIL", what);
+    return (pass != 0) ? 0U : 1U;
+}
+
+#if HOST_REF_EN
+/****************************************************************************************
+* RefTemplatesInit - Each TRICK_DB axis as TrickMatchInit() prepares it, in doubles
+****************************************************************************************/
+static void RefTemplatesInit(void) {
+    INT32S mean;
+    INT32S maxAbs;
+    for (INT8U t = 0; t < NUM_DB_TRICKS; t++) {
+        for (INT8U axis = 0; axis < NUM_AXES; axis++) {
+            TemplateScale(TRICK_DB[t][axis], &mean, &maxAbs);
+            for (INT16U i = 0; i < SAMPLES_PER_BLOCK; i++) {
+                RefTemplate[t][axis][i] = TEMPLATE_SAMPLE(TRICK_DB[t][axis][i], mean, maxAbs);
+            }
+        }
+    }
+}
+
+/****************************************************************************************
+* RefPearson - Pearson correlation of n samples in double precision
+****************************************************************************************/
+static FP64 RefPearson(const FP64* x, const FP64* y, INT32S n) {
+    FP64 sx = 0.0;
+    FP64 sy = 0.0;
+    FP64 sxx = 0.0;
+    FP64 syy = 0.0;
+    FP64 sxy = 0.0;
+    for (INT32S i = 0; i < n; i++) {
+        sx += x[i];
+        sy += y[i];
+        sxx += x[i] * x[i];
+        syy += y[i] * y[i];
+        sxy += x[i] * y[i];
+    }
+    return (sxy - (sx * sy / n)) / sqrt((sxx - (sx * sx / n)) * (syy - (sy * sy / n)));
+}
+
+/****************************************************************************************
+* RefLagCorrel - Mean over the axes of the reference correlation with the capture offset
+*                by lag, over the overlap only
+****************************************************************************************/
+static FP64 RefLagCorrel(INT8U trick, INT32S lag) {
+    static FP64 x[SAMPLES_PER_BLOCK];
+    INT16S* capture[NUM_AXES] = {Capture.samplesX, Capture.samplesY, Capture.samplesZ};
+    INT32S n = SAMPLES_PER_BLOCK - abs(lag);
+    FP64 total = 0.0;
+    for (INT8U axis = 0; axis < NUM_AXES; axis++) {
+        for (INT32S i = 0; i < n; i++) {
+            x[i] = capture[axis][(lag >= 0) ? (i + lag) : i];
+        }
+        total += RefPearson(x, &RefTemplate[trick][axis][(lag >= 0) ? 0 : -lag], n);
+    }
+    return total / NUM_AXES;
+}
+
+/****************************************************************************************
+* RefBestLag - Brute force search of +/-MATCH_MAX_LAG, ties to the smaller offset
+****************************************************************************************/
+static INT32S RefBestLag(INT8U trick, FP64* corr) {
+    INT32S best = 0;
+    FP64 r;
+    *corr = -2.0;
+    for (INT32S lag = -MATCH_MAX_LAG; lag <= MATCH_MAX_LAG; lag++) {
+        r = RefLagCorrel(trick, lag);
+        if ((r > *corr + 1e-12) || ((fabs(r - *corr) <= 1e-12) && (abs(lag) < abs(best)))) {
+            *corr = r;
+            best = lag;
+        } else {}
+    }
+    return best;
+}
+#endif
+
+#if HOST_REF_EN
+/****************************************************************************************
+* CheckKernels - CorrelSums() and CorrelFromSums() on every normalized TRICK_DB recording
+*                against every prepared template axis, against the reference
+****************************************************************************************/
+static INT32U CheckKernels(void) {
+    static FP64 x[SAMPLES_PER_BLOCK];
+    static INT16S y[SAMPLES_PER_BLOCK];
+    INT16S* capture[NUM_AXES] = {Capture.samplesX, Capture.samplesY, Capture.samplesZ};
+    CORREL_SUMS sums;
+    FP64 worst = 0.0;
+    FP64 err;
+    char line[80];
+    for (INT8U c = 0; c < NUM_DB_TRICKS; c++) {
+        CaptureShifted(c, 0);
+#if MATCH_INCREMENTAL_EN
+        CaptureNormalize();
+#endif
+        for (INT8U t = 0; t < NUM_DB_TRICKS; t++) {
+            for (INT8U axis = 0; axis < NUM_AXES; axis++) {
+                for (INT16U i = 0; i < SAMPLES_PER_BLOCK; i++) {
+                    x[i] = capture[axis][i];
+                    y[i] = (INT16S)RefTemplate[t][axis][i];
+                }
+                CorrelSums(capture[axis], y, SAMPLES_PER_BLOCK, &sums);
+                err = fabs((CorrelFromSums(&sums, SAMPLES_PER_BLOCK) / 2147483648.0) -
+                           RefPearson(x, RefTemplate[t][axis], SAMPLES_PER_BLOCK));
+                worst = (err > worst) ? err : worst;
+            }
+        }
+    }
+    snprintf(line, sizeof(line), "CorrelSums+CorrelFromSums, worst error %.2e", worst);
+    return Check(line, (worst < CORREL_TOLERANCE) ? 1U : 0U);
+}
+#endif
+
+#if MATCH_CORREL_EN
+
+/****************************************************************************************
+* CheckSquareRoot - SquareRoot() on random 64 bit values of every size. It must round to
+*                   the nearest integer, off by at most 1/ROOT_MANTISSA of the root more
+*                   where the root has over 24 bits.
+****************************************************************************************/
+static INT32U CheckSquareRoot(void) {
+    INT64U a;
+    FP64 root;
+    FP64 allowed;
+    FP64 ratio;
+    FP64 worst = 0.0;
+    char line[80];
+    srand(1);
+    for (INT32U k = 0; k < 200000U; k++) {
+        a = ((((INT64U)(INT32U)rand()) << 31) ^ (INT64U)(INT32U)rand()) >> (rand() % 62);
+        root = sqrt((FP64)a);
+        allowed = 0.5 + (root / ROOT_MANTISSA);     // Integer rounding, then the float
+        ratio = fabs((FP64)SquareRoot(a) - root) / allowed;
+        worst = (ratio > worst) ? ratio : worst;
+    }
+    snprintf(line, sizeof(line), "SquareRoot, worst error %.3f of the allowed", worst);
+    return Check(line, (worst <= 1.0) ? 1U : 0U);
+}
+
+/****************************************************************************************
+* Seconds - Monotonic clock
+****************************************************************************************/
+static FP64 Seconds(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (FP64)now.tv_sec + ((FP64)now.tv_nsec * 1e-9);
+}
+
+/****************************************************************************************
+* BenchKernels - Host time of one axis correlation, the original CorrelCoeff against the
+*                fused kernel. Only printed, host times do not carry over to the M4.
+****************************************************************************************/
+static void BenchKernels(void) {
+#if TRICK_BENCH_EN
+    INT16S* x = (INT16S*)TRICK_DB[0][0];
+    INT16S* y = (INT16S*)TRICK_DB[NUM_DB_TRICKS - 1][0];
+    CORREL_SUMS sums;
+    volatile INT32S corr;
+    FP64 start;
+    FP64 legacy = 1e9;
+    FP64 fused = 1e9;
+
+    for (INT8U repeat = 0; repeat < BENCH_REPEATS; repeat++) {
+        start = Seconds();
+        for (INT32U i = 0; i < BENCH_RUNS; i++) {
+            corr = LegacyCorrelCoeff(x, y);
+        }
+        legacy = fmin(legacy, Seconds() - start);
+        start = Seconds();
+        for (INT32U i = 0; i < BENCH_RUNS; i++) {
+            CorrelSums(x, y, SAMPLES_PER_BLOCK, &sums);
+            corr = CorrelFromSums(&sums, SAMPLES_PER_BLOCK);
+        }
+        fused = fmin(fused, Seconds() - start);
+    }
+    (void)corr;
+    printf("  time legacy CorrelCoeff %.2fus, CorrelSums+CorrelFromSums %.2fus per axis\n",
+           legacy / BENCH_RUNS * 1e6, fused / BENCH_RUNS * 1e6);
+#endif
+}
+#endif
+
+/****************************************************************************************
+* CheckMatches - Each recording delayed by shift samples must be identified as itself.
+*                The correlation engines must also find the reference lag and score.
+****************************************************************************************/
+static INT32U CheckMatches(INT32S shift) {
+    TRICK_MATCH match;
+    INT32U id;
+    INT32U failed = 0;
+    char line[120];
+#if HOST_REF_EN
+    FP64 refCorr;
+    INT32S refLag;
+#endif
+    for (INT8U c = 0; c < NUM_DB_TRICKS; c++) {
+        CaptureShifted(c, shift);
+        id = TrickIdentify(&Capture, &match);
+#if HOST_REF_EN
+        refLag = RefBestLag(c, &refCorr);
+        snprintf(line, sizeof(line), "shift %+d trick %u: id %u lag %+d corr %.4f, reference lag %+d corr %.4f",
+                 (int)shift, (unsigned)(c + 1U), (unsigned)id, match.lag, match.corr / 2147483648.0,
+                 (int)refLag, refCorr);
+        failed += Check(line, ((id == (c + 1U)) && (match.lag == refLag) &&
+                               (fabs((match.corr / 2147483648.0) - refCorr) < MATCH_TOLERANCE)) ? 1U : 0U);
+#else
+        snprintf(line, sizeof(line), "shift %+d trick %u: id %u distance %u", (int)shift,
+                 (unsigned)(c + 1U), (unsigned)id, (unsigned)match.distance);
+        failed += Check(line, (id == (c + 1U)) ? 1U : 0U);
+#endif
+    }
+    return failed;
+}
+
+#if MATCH_CASCADE_EN
+/****************************************************************************************
+* CheckCascade - Each recording shifted by up to MATCH_MAX_LAG, at 1/2, 1/3 and 1/5 gain,
+*                with no noise and with +/-100 and +/-400 counts of it, must keep its own
+*                template. At least CASCADE_MIN_PRUNED percent of the other templates
+*                must be pruned over all of them.
+****************************************************************************************/
+static INT32U CheckCascade(void) {
+    static const INT32S gains[] = {2, 3, 5};
+    static const INT32S noises[] = {0, 100, 400};
+    INT16S* capture[NUM_AXES] = {Capture.samplesX, Capture.samplesY, Capture.samplesZ};
+    INT8U keep[NUM_DB_TRICKS];
+    INT32U seed = 1;
+    INT32U lost = 0;
+    INT32U pruned = 0;
+    INT32U others = 0;
+    INT32S j;
+    char line[120];
+    for (INT8U c = 0; c < NUM_DB_TRICKS; c++) {
+        for (INT32S shift = -MATCH_MAX_LAG; shift <= MATCH_MAX_LAG; shift += MATCH_MAX_LAG / 8) {
+            for (INT8U g = 0; g < (sizeof(gains) / sizeof(gains[0])); g++) {
+                for (INT8U n = 0; n < (sizeof(noises) / sizeof(noises[0])); n++) {
+                    for (INT8U axis = 0; axis < NUM_AXES; axis++) {
+                        for (INT32S i = 0; i < SAMPLES_PER_BLOCK; i++) {
+                            j = i - shift;
+                            j = (j < 0) ? 0 : ((j >= SAMPLES_PER_BLOCK) ? (SAMPLES_PER_BLOCK - 1) : j);
+                            seed = (seed * 1103515245U) + 12345U;
+                            capture[axis][i] = (INT16S)((TRICK_DB[c][axis][j] / gains[g]) +
+                                                        ((INT32S)((seed >> 16) % (2U * (INT32U)noises[n] + 1U)) - noises[n]));
+                        }
+                    }
+                    pruned += NUM_DB_TRICKS - CascadePrune(capture, SAMPLES_PER_BLOCK, keep);
+                    lost += (keep[c] == 0) ? 1U : 0U;
+                    pruned -= (keep[c] == 0) ? 1U : 0U;
+                    others += NUM_DB_TRICKS - 1U;
+                }
+            }
+        }
+    }
+    snprintf(line, sizeof(line), "cascade: own template pruned %u times, others pruned %u of %u",
+             (unsigned)lost, (unsigned)pruned, (unsigned)others);
+    return Check(line, ((lost == 0) && ((pruned * 100U) >= (others * CASCADE_MIN_PRUNED))) ? 1U : 0U);
+}
+#endif
+
+#if MATCH_EARLY_EN
+/****************************************************************************************
+* CheckEarly - Each recording delayed by shift samples is fed one sample at a time, as
+*              FillAccelBuffers does, and offered to TrickIdentifyEarly() after each. It
+*              must be decided, and as itself, before the window fills.
+****************************************************************************************/
+static INT32U CheckEarly(INT32S shift) {
+    TRICK_MATCH match;
+    INT32U id;
+    INT32U failed = 0;
+    INT32S j;
+    INT16U count;
+    char line[120];
+    for (INT8U c = 0; c < NUM_DB_TRICKS; c++) {
+        id = 0;
+        for (count = 0; (count < SAMPLES_PER_BLOCK) && (id == 0); count++) {
+            j = (INT32S)count - shift;
+            j = (j < 0) ? 0 : ((j >= SAMPLES_PER_BLOCK) ? (SAMPLES_PER_BLOCK - 1) : j);
+            Capture.samplesX[count] = (INT16S)(TRICK_DB[c][0][j] / 2);
+            Capture.samplesY[count] = (INT16S)(TRICK_DB[c][1][j] / 2);
+            Capture.samplesZ[count] = (INT16S)(TRICK_DB[c][2][j] / 2);
+            ACCEL_DATA_3D sample = {Capture.samplesX[count], Capture.samplesY[count], Capture.samplesZ[count]};
+            TrickMatchAccumulate(&sample, count);
+            id = TrickIdentifyEarly(&Capture, (INT16U)(count + 1U), &match);
+        }
+        snprintf(line, sizeof(line), "early shift %+d trick %u: id %u after %u samples, lag %+d corr %.4f",
+                 (int)shift, (unsigned)(c + 1U), (unsigned)id, (unsigned)count, match.lag,
+                 (id != 0) ? (match.corr / 2147483648.0) : 0.0);
+        failed += Check(line, (id == (c + 1U)) ? 1U : 0U);
+    }
+    return failed;
+}
+#endif